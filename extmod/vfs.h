@@ -50,6 +50,10 @@
 typedef struct _mp_vfs_proto_t {
     MP_PROTOCOL_HEAD
     mp_import_stat_t (*import_stat)(void *self, const char *path);
+    #if MICROPY_PERSISTENT_CODE_XIP
+    // optional, see mp_reader_map_file
+    const byte *(*map_file)(void *self, const char *path, size_t *len);
+    #endif
 } mp_vfs_proto_t;
 
 typedef struct _mp_vfs_mount_t {
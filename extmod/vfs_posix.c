@@ -35,6 +35,11 @@
 #include <string.h>
 #include <sys/stat.h>
 #include <dirent.h>
+#if MICROPY_PERSISTENT_CODE_XIP
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#endif
 
 typedef struct _mp_obj_vfs_posix_t {
     mp_obj_base_t base;
@@ -90,6 +95,33 @@ STATIC mp_import_stat_t mp_vfs_posix_import_stat(void *self_in, const char *path
     return MP_IMPORT_STAT_NO_EXIST;
 }
 
+#if MICROPY_PERSISTENT_CODE_XIP
+STATIC const byte *mp_vfs_posix_map_file(void *self_in, const char *path, size_t *len) {
+    mp_obj_vfs_posix_t *self = self_in;
+    if (self->root_len != 0) {
+        self->root.len = self->root_len;
+        vstr_add_str(&self->root, path);
+        path = vstr_null_terminated_str(&self->root);
+    }
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        return NULL;
+    }
+    struct stat st;
+    void *buf = MAP_FAILED;
+    if (fstat(fd, &st) == 0 && S_ISREG(st.st_mode) && st.st_size > 0) {
+        // the mapping is never removed, the code may run until the end
+        buf = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    }
+    close(fd);
+    if (buf == MAP_FAILED) {
+        return NULL;
+    }
+    *len = st.st_size;
+    return buf;
+}
+#endif
+
 STATIC mp_obj_t vfs_posix_make_new(const mp_obj_type_t *type, size_t n_args, const mp_obj_t *args, mp_map_t *kw_args) {
     mp_arg_check_num(n_args, kw_args, 0, 1, false);
 
@@ -352,6 +384,9 @@ STATIC MP_DEFINE_CONST_DICT(vfs_posix_locals_dict, vfs_posix_locals_dict_table);
 STATIC const mp_vfs_proto_t vfs_posix_proto = {
     MP_PROTO_IMPLEMENT(MP_QSTR_protocol_vfs)
     .import_stat = mp_vfs_posix_import_stat,
+    #if MICROPY_PERSISTENT_CODE_XIP
+    .map_file = mp_vfs_posix_map_file,
+    #endif
 };
 
 const mp_obj_type_t mp_type_vfs_posix = {
@@ -38,41 +38,75 @@ typedef struct _mp_reader_vfs_t {
     mp_obj_t file;
     uint16_t len;
     uint16_t pos;
-    byte buf[24];
+    byte buf[MICROPY_READER_BUF_SIZE];
 } mp_reader_vfs_t;
 
-STATIC mp_uint_t mp_reader_vfs_readbyte(void *data) {
-    mp_reader_vfs_t *reader = (mp_reader_vfs_t*)data;
+// Refill the buffer if it's all been read, and return false at end of stream
+STATIC bool mp_reader_vfs_fill(mp_reader_vfs_t *reader) {
     if (reader->pos >= reader->len) {
-        if (reader->len < sizeof(reader->buf)) {
-            return MP_READER_EOF;
+        if (reader->len == 0) {
+            return false;
         } else {
             int errcode;
             reader->len = mp_stream_rw(reader->file, reader->buf, sizeof(reader->buf),
                 &errcode, MP_STREAM_RW_READ | MP_STREAM_RW_ONCE);
             if (errcode != 0) {
                 // TODO handle errors properly
-                return MP_READER_EOF;
+                reader->len = 0;
+                return false;
             }
             if (reader->len == 0) {
-                return MP_READER_EOF;
+                return false;
             }
             reader->pos = 0;
         }
     }
+    return true;
+}
+
+STATIC mp_uint_t mp_reader_vfs_readbyte(void *data) {
+    mp_reader_vfs_t *reader = (mp_reader_vfs_t*)data;
+    if (!mp_reader_vfs_fill(reader)) {
+        return MP_READER_EOF;
+    }
     return reader->buf[reader->pos++];
 }
 
+STATIC const byte *mp_reader_vfs_readbuf(void *data, size_t *len) {
+    mp_reader_vfs_t *reader = (mp_reader_vfs_t*)data;
+    if (!mp_reader_vfs_fill(reader)) {
+        return NULL;
+    }
+    const byte *buf = reader->buf + reader->pos;
+    *len = reader->len - reader->pos;
+    reader->pos = reader->len;
+    return buf;
+}
+
 STATIC void mp_reader_vfs_close(void *data) {
     mp_reader_vfs_t *reader = (mp_reader_vfs_t*)data;
     mp_stream_close(reader->file);
-    m_del_obj(mp_reader_vfs_t, reader);
+    // keep one closed reader around, so that importing a module doesn't need
+    // to find room on the heap for a new buffer every time; readers are
+    // long-lived so that the spare doesn't pin the short-lived heap
+    if (MP_STATE_VM(reader_vfs_spare) == NULL) {
+        reader->file = MP_OBJ_NULL;
+        MP_STATE_VM(reader_vfs_spare) = reader;
+    } else {
+        m_del_obj(mp_reader_vfs_t, reader);
+    }
 }
 
 void mp_reader_new_file(mp_reader_t *reader, const char *filename) {
-    mp_reader_vfs_t *rf = m_new_obj(mp_reader_vfs_t);
     mp_obj_t arg = mp_obj_new_str(filename, strlen(filename));
-    rf->file = mp_vfs_open(1, &arg, (mp_map_t*)&mp_const_empty_map);
+    mp_obj_t file = mp_vfs_open(1, &arg, (mp_map_t*)&mp_const_empty_map);
+    mp_reader_vfs_t *rf = MP_STATE_VM(reader_vfs_spare);
+    if (rf != NULL) {
+        MP_STATE_VM(reader_vfs_spare) = NULL;
+    } else {
+        rf = m_new_ll_obj(mp_reader_vfs_t);
+    }
+    rf->file = file;
     int errcode;
     rf->len = mp_stream_rw(rf->file, rf->buf, sizeof(rf->buf), &errcode, MP_STREAM_RW_READ | MP_STREAM_RW_ONCE);
     if (errcode != 0) {
@@ -82,6 +116,22 @@ void mp_reader_new_file(mp_reader_t *reader, const char *filename) {
     reader->data = rf;
     reader->readbyte = mp_reader_vfs_readbyte;
     reader->close = mp_reader_vfs_close;
+    reader->readbuf = mp_reader_vfs_readbuf;
+}
+
+#if MICROPY_PERSISTENT_CODE_XIP
+const byte *mp_reader_map_file(const char *filename, size_t *len) {
+    const char *path_out;
+    mp_vfs_mount_t *vfs = mp_vfs_lookup_path(filename, &path_out);
+    if (vfs == MP_VFS_NONE || vfs == MP_VFS_ROOT) {
+        return NULL;
+    }
+    const mp_vfs_proto_t *proto = (mp_vfs_proto_t*)mp_proto_get(MP_QSTR_protocol_vfs, vfs->obj);
+    if (proto == NULL || proto->map_file == NULL) {
+        return NULL;
+    }
+    return proto->map_file(MP_OBJ_TO_PTR(vfs->obj), path_out, len);
 }
+#endif
 
 #endif // MICROPY_READER_VFS
@@ -94,7 +94,15 @@ void do_str(const char *src, mp_parse_input_kind_t input_kind) {
     }
 }
 
-void start_mp(supervisor_allocation* heap) {
+static supervisor_allocation* allocate_pystack(void) {
+    #if MICROPY_ENABLE_PYSTACK
+    return allocate_memory(CIRCUITPY_PYSTACK_SIZE, false);
+    #else
+    return NULL;
+    #endif
+}
+
+void start_mp(supervisor_allocation* heap, supervisor_allocation* pystack) {
     reset_status_led();
     autoreload_stop();
 
@@ -118,8 +126,22 @@ void start_mp(supervisor_allocation* heap) {
     // Clear the readline history. It references the heap we're about to destroy.
     readline_init0();
 
+    uint32_t* heap_end = heap->ptr + heap->length / 4;
+    #if MICROPY_ENABLE_PYSTACK
+    if (pystack != NULL) {
+        mp_pystack_init(pystack->ptr, pystack->ptr + pystack->length / 4);
+    } else {
+        // No separate allocation was available so carve the pystack off the
+        // end of the heap instead.
+        heap_end -= CIRCUITPY_PYSTACK_SIZE / 4;
+        mp_pystack_init(heap_end, heap_end + CIRCUITPY_PYSTACK_SIZE / 4);
+    }
+    #else
+    (void)pystack;
+    #endif
+
     #if MICROPY_ENABLE_GC
-    gc_init(heap->ptr, heap->ptr + heap->length / 4);
+    gc_init(heap->ptr, heap_end);
     #endif
     mp_init();
     mp_obj_list_init(mp_sys_path, 0);
@@ -184,7 +206,7 @@ bool maybe_run_list(const char ** filenames, pyexec_result_t* exec_result) {
     return true;
 }
 
-void cleanup_after_vm(supervisor_allocation* heap) {
+void cleanup_after_vm(supervisor_allocation* heap, supervisor_allocation* pystack) {
     // Turn off the display and flush the fileystem before the heap disappears.
     #if CIRCUITPY_DISPLAYIO
     reset_displays();
@@ -192,6 +214,9 @@ void cleanup_after_vm(supervisor_allocation* heap) {
     filesystem_flush();
     stop_mp();
     free_memory(heap);
+    if (pystack != NULL) {
+        free_memory(pystack);
+    }
     supervisor_move_memory();
 
     reset_port();
@@ -236,8 +261,9 @@ bool run_code_py(safe_mode_t safe_mode) {
 
         stack_resize();
         filesystem_flush();
+        supervisor_allocation* pystack = allocate_pystack();
         supervisor_allocation* heap = allocate_remaining_memory();
-        start_mp(heap);
+        start_mp(heap, pystack);
         found_main = maybe_run_list(supported_filenames, &result);
         if (!found_main){
             found_main = maybe_run_list(double_extension_filenames, &result);
@@ -245,7 +271,7 @@ bool run_code_py(safe_mode_t safe_mode) {
                 serial_write_compressed(translate("WARNING: Your code filename has two extensions\n"));
             }
         }
-        cleanup_after_vm(heap);
+        cleanup_after_vm(heap, pystack);
 
         if (result.return_code & PYEXEC_FORCED_EXIT) {
             return reload_requested;
@@ -366,8 +392,9 @@ void __attribute__ ((noinline)) run_boot_py(safe_mode_t safe_mode) {
 
         // TODO(tannewt): Allocate temporary space to hold custom usb descriptors.
         filesystem_flush();
+        supervisor_allocation* pystack = allocate_pystack();
         supervisor_allocation* heap = allocate_remaining_memory();
-        start_mp(heap);
+        start_mp(heap, pystack);
 
         // TODO(tannewt): Re-add support for flashing boot error output.
         bool found_boot = maybe_run_list(boot_py_filenames, NULL);
@@ -381,7 +408,7 @@ void __attribute__ ((noinline)) run_boot_py(safe_mode_t safe_mode) {
         boot_output_file = NULL;
         #endif
 
-        cleanup_after_vm(heap);
+        cleanup_after_vm(heap, pystack);
     }
 }
 
@@ -389,8 +416,9 @@ int run_repl(void) {
     int exit_code = PYEXEC_FORCED_EXIT;
     stack_resize();
     filesystem_flush();
+    supervisor_allocation* pystack = allocate_pystack();
     supervisor_allocation* heap = allocate_remaining_memory();
-    start_mp(heap);
+    start_mp(heap, pystack);
     autoreload_suspend();
     new_status_color(REPL_RUNNING);
     if (pyexec_mode_kind == PYEXEC_MODE_RAW_REPL) {
@@ -398,7 +426,7 @@ int run_repl(void) {
     } else {
         exit_code = pyexec_friendly_repl();
     }
-    cleanup_after_vm(heap);
+    cleanup_after_vm(heap, pystack);
     autoreload_resume();
     return exit_code;
 }
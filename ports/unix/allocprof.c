@@ -0,0 +1,151 @@
+/*
+ * This file is part of the MicroPython project, http://micropython.org/
+ *
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2020 CircuitPython contributors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "py/bc.h"
+#include "py/gc.h"
+#include "py/mpstate.h"
+#include "py/qstr.h"
+
+#if MICROPY_GC_ALLOC_PROFILE
+
+// Allocations are aggregated by the stack of bytecode frames that made them,
+// kept in the "collapsed" form used by flamegraph tools: one frame per entry,
+// outermost first, separated by semicolons. The table lives in the C heap so
+// that recording never touches the GC heap.
+
+#define ALLOC_PROFILE_BUCKETS (4096)
+#define ALLOC_PROFILE_MAX_DEPTH (64)
+#define ALLOC_PROFILE_MAX_STACK (2048)
+
+typedef struct _alloc_profile_entry_t {
+    struct _alloc_profile_entry_t *next;
+    size_t count;
+    size_t bytes;
+    char stack[];
+} alloc_profile_entry_t;
+
+STATIC const char *alloc_profile_path;
+STATIC alloc_profile_entry_t *alloc_profile_table[ALLOC_PROFILE_BUCKETS];
+
+void mp_unix_alloc_profile_start(const char *path) {
+    alloc_profile_path = path;
+}
+
+STATIC size_t alloc_profile_format_stack(char *buf, size_t len) {
+    mp_code_state_t *frames[ALLOC_PROFILE_MAX_DEPTH];
+    size_t depth = 0;
+    for (mp_code_state_t *cs = MP_STATE_THREAD(current_code_state); cs != NULL && depth < ALLOC_PROFILE_MAX_DEPTH; cs = cs->caller) {
+        frames[depth++] = cs;
+    }
+    if (depth == 0) {
+        return snprintf(buf, len, "[native]");
+    }
+    size_t n = 0;
+    while (depth > 0 && n < len) {
+        qstr block_name;
+        qstr source_file;
+        size_t source_line;
+        mp_code_state_get_location(frames[--depth], &block_name, &source_file, &source_line);
+        n += snprintf(buf + n, len - n, "%s%s (%s:%u)", n == 0 ? "" : ";",
+            qstr_str(block_name), qstr_str(source_file), (unsigned)source_line);
+    }
+    return n < len ? n : len - 1;
+}
+
+void gc_alloc_profile_record(size_t n_bytes) {
+    if (alloc_profile_path == NULL) {
+        return;
+    }
+    char stack[ALLOC_PROFILE_MAX_STACK];
+    size_t len = alloc_profile_format_stack(stack, sizeof(stack));
+
+    uint32_t hash = 5381;
+    for (size_t i = 0; i < len; i++) {
+        hash = hash * 33 + (byte)stack[i];
+    }
+    alloc_profile_entry_t **bucket = &alloc_profile_table[hash & (ALLOC_PROFILE_BUCKETS - 1)];
+    alloc_profile_entry_t *e = *bucket;
+    while (e != NULL && strcmp(e->stack, stack) != 0) {
+        e = e->next;
+    }
+    if (e == NULL) {
+        e = malloc(sizeof(alloc_profile_entry_t) + len + 1);
+        if (e == NULL) {
+            return;
+        }
+        memcpy(e->stack, stack, len + 1);
+        e->count = 0;
+        e->bytes = 0;
+        e->next = *bucket;
+        *bucket = e;
+    }
+    e->count += 1;
+    e->bytes += n_bytes;
+}
+
+// Write the bytes allocated by each stack to the path given at the start, and
+// the number of allocations to the same path with ".count" appended.
+void mp_unix_alloc_profile_write(void) {
+    if (alloc_profile_path == NULL) {
+        return;
+    }
+    size_t path_len = strlen(alloc_profile_path);
+    char *count_path = malloc(path_len + sizeof(".count"));
+    if (count_path == NULL) {
+        return;
+    }
+    memcpy(count_path, alloc_profile_path, path_len);
+    memcpy(count_path + path_len, ".count", sizeof(".count"));
+    FILE *bytes_file = fopen(alloc_profile_path, "w");
+    FILE *count_file = fopen(count_path, "w");
+    for (size_t i = 0; i < ALLOC_PROFILE_BUCKETS; i++) {
+        for (alloc_profile_entry_t *e = alloc_profile_table[i]; e != NULL; e = e->next) {
+            if (bytes_file != NULL) {
+                fprintf(bytes_file, "%s %lu\n", e->stack, (unsigned long)e->bytes);
+            }
+            if (count_file != NULL) {
+                fprintf(count_file, "%s %lu\n", e->stack, (unsigned long)e->count);
+            }
+        }
+    }
+    if (bytes_file == NULL || count_file == NULL) {
+        fprintf(stderr, "could not write allocation profile to %s\n", bytes_file == NULL ? alloc_profile_path : count_path);
+    }
+    if (bytes_file != NULL) {
+        fclose(bytes_file);
+    }
+    if (count_file != NULL) {
+        fclose(count_file);
+    }
+    free(count_path);
+    alloc_profile_path = NULL;
+}
+
+#endif // MICROPY_GC_ALLOC_PROFILE
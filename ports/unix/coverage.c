@@ -435,4 +435,10 @@ STATIC mp_obj_t extra_coverage(void) {
 }
 MP_DEFINE_CONST_FUN_OBJ_0(extra_coverage_obj, extra_coverage);
 
+// number of chains of blocks traced by the last collection
+STATIC mp_obj_t gc_mark_count(void) {
+    return mp_obj_new_int_from_uint(MP_STATE_MEM(gc_mark_count));
+}
+MP_DEFINE_CONST_FUN_OBJ_0(gc_mark_count_obj, gc_mark_count);
+
 #endif
@@ -322,6 +322,13 @@ STATIC int usage(char **argv) {
 , heap_size);
     impl_opts_cnt++;
 #endif
+#if MICROPY_GC_ALLOC_PROFILE
+    printf(
+"  allocprof=<file> -- write bytes allocated per Python stack to <file>,\n"
+"                      and allocation counts to <file>.count, for flamegraphs\n"
+);
+    impl_opts_cnt++;
+#endif
 
     if (impl_opts_cnt == 0) {
         printf("  (none)\n");
@@ -380,6 +387,10 @@ STATIC void pre_process_options(int argc, char **argv) {
                     if (heap_size < 700) {
                         goto invalid_arg;
                     }
+#endif
+#if MICROPY_GC_ALLOC_PROFILE
+                } else if (strncmp(argv[a + 1], "allocprof=", sizeof("allocprof=") - 1) == 0) {
+                    mp_unix_alloc_profile_start(argv[a + 1] + sizeof("allocprof=") - 1);
 #endif
                 } else {
 invalid_arg:
@@ -520,6 +531,8 @@ MP_NOINLINE int main_(int argc, char **argv) {
     {
         MP_DECLARE_CONST_FUN_OBJ_0(extra_coverage_obj);
         mp_store_global(QSTR_FROM_STR_STATIC("extra_coverage"), MP_OBJ_FROM_PTR(&extra_coverage_obj));
+        MP_DECLARE_CONST_FUN_OBJ_0(gc_mark_count_obj);
+        mp_store_global(QSTR_FROM_STR_STATIC("gc_mark_count"), MP_OBJ_FROM_PTR(&gc_mark_count_obj));
     }
     #endif
 
@@ -659,6 +672,10 @@ MP_NOINLINE int main_(int argc, char **argv) {
     gc_sweep_all();
     #endif
 
+    #if MICROPY_GC_ALLOC_PROFILE
+    mp_unix_alloc_profile_write();
+    #endif
+
     mp_deinit();
 
 #if MICROPY_ENABLE_GC && !defined(NDEBUG)
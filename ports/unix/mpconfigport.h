@@ -46,9 +46,14 @@
 #define MICROPY_COMP_MODULE_CONST   (1)
 #define MICROPY_COMP_TRIPLE_TUPLE_ASSIGN (1)
 #define MICROPY_COMP_RETURN_IF_EXPR (1)
+#define MICROPY_COMP_STREAMING      (1)
 #define MICROPY_ENABLE_GC           (1)
 #define MICROPY_ENABLE_FINALISER    (1)
+#define MICROPY_GC_FREE_LIST_CACHE  (1)
+#define MICROPY_GC_INCREMENTAL_SWEEP (1)
+#define MICROPY_GC_COMPACT          (1)
 #define MICROPY_STACK_CHECK         (1)
+#define MICROPY_QSTR_HASH_INDEX     (1)
 #define MICROPY_MALLOC_USES_ALLOCATED_SIZE (1)
 #define MICROPY_MEM_STATS           (1)
 #define MICROPY_DEBUG_PRINTERS      (1)
@@ -56,6 +61,7 @@
 // check stdout a chance to pass, etc.
 #define MICROPY_DEBUG_PRINTER_DEST  mp_stderr_print
 #define MICROPY_READER_POSIX        (1)
+#define MICROPY_READER_BUF_SIZE     (256)
 #define MICROPY_USE_READLINE_HISTORY (1)
 #define MICROPY_HELPER_REPL         (1)
 #define MICROPY_REPL_EMACS_KEYS     (1)
@@ -70,9 +76,18 @@
 #ifndef MICROPY_OPT_CACHE_MAP_LOOKUP_IN_BYTECODE
 #define MICROPY_OPT_CACHE_MAP_LOOKUP_IN_BYTECODE (1)
 #endif
+#define MICROPY_OPT_TYPE_ATTR_CACHE (1)
+#define MICROPY_OPT_TYPE_ATTR_CACHE_SIZE (64)
+#define MICROPY_OPT_MAP_LOOKUP_CACHE (1)
+#define MICROPY_OPT_MAP_LOOKUP_CACHE_SIZE (256)
+#define MICROPY_OPT_LOAD_GLOBAL_CACHE (1)
+#define MICROPY_OPT_LOAD_GLOBAL_CACHE_SIZE (64)
+#define MICROPY_OPT_QUICKEN         (1)
+#define MICROPY_OPT_FOR_ITER_INLINE (1)
 #define MICROPY_CAN_OVERRIDE_BUILTINS (1)
 #define MICROPY_PY_FUNCTION_ATTRS   (1)
 #define MICROPY_PY_DESCRIPTORS      (1)
+#define MICROPY_PY_SLOTS            (1)
 #define MICROPY_PY_BUILTINS_STR_UNICODE (1)
 #define MICROPY_PY_BUILTINS_STR_CENTER (1)
 #define MICROPY_PY_BUILTINS_STR_PARTITION (1)
@@ -254,6 +269,8 @@ typedef long mp_off_t;
 void mp_unix_alloc_exec(size_t min_size, void** ptr, size_t *size);
 void mp_unix_free_exec(void *ptr, size_t size);
 void mp_unix_mark_exec(void);
+void mp_unix_alloc_profile_start(const char *path);
+void mp_unix_alloc_profile_write(void);
 #define MP_PLAT_ALLOC_EXEC(min_size, ptr, size) mp_unix_alloc_exec(min_size, ptr, size)
 #define MP_PLAT_FREE_EXEC(ptr, size) mp_unix_free_exec(ptr, size)
 #ifndef MICROPY_FORCE_PLAT_ALLOC_EXEC
@@ -0,0 +1,7 @@
+// This config file builds an interpreter that records the Python stack of
+// every GC allocation, for finding the code that causes GC pressure. Run it
+// with -X allocprof=<file> to write the profile when it exits.
+
+#include <mpconfigport.h>
+
+#define MICROPY_GC_ALLOC_PROFILE (1)
@@ -34,6 +34,10 @@
 
 #define MICROPY_FLOAT_HIGH_QUALITY_HASH (1)
 #define MICROPY_ENABLE_SCHEDULER       (1)
+#define MICROPY_ENABLE_PYSTACK         (1)
+#define MICROPY_PERSISTENT_CODE_SAVE   (1)
+#define MICROPY_PERSISTENT_CODE_XIP    (1)
+#define MICROPY_MODULE_CACHE           (1)
 #define MICROPY_READER_VFS             (1)
 #define MICROPY_PY_DELATTR_SETATTR     (1)
 #define MICROPY_PY_REVERSE_SPECIAL_METHODS (1)
@@ -50,6 +54,7 @@
 #define MICROPY_FATFS_USE_LABEL        (1)
 #define MICROPY_PY_FRAMEBUF            (1)
 #define MICROPY_PY_COLLECTIONS_NAMEDTUPLE__ASDICT (1)
+#define MICROPY_GC_MARK_COUNT          (1)
 
 // TODO these should be generic, not bound to fatfs
 #define mp_type_fileio mp_type_vfs_posix_fileio
@@ -294,6 +294,62 @@ continue2:;
     dump_args(code_state->state, n_state);
 }
 
+// Find the function, file and line of the instruction at code_state->ip.
+void mp_code_state_get_location(const mp_code_state_t *code_state, qstr *block_name, qstr *source_file, size_t *source_line) {
+    const byte *ip = code_state->fun_bc->bytecode;
+    ip = mp_decode_uint_skip(ip); // skip n_state
+    ip = mp_decode_uint_skip(ip); // skip n_exc_stack
+    ip++; // skip scope_params
+    ip++; // skip n_pos_args
+    ip++; // skip n_kwonly_args
+    ip++; // skip n_def_pos_args
+    size_t bc = code_state->ip - ip;
+    size_t code_info_size = mp_decode_uint_value(ip);
+    ip = mp_decode_uint_skip(ip); // skip code_info_size
+    bc -= code_info_size;
+    #if MICROPY_PERSISTENT_CODE
+    *block_name = ip[0] | (ip[1] << 8);
+    *source_file = ip[2] | (ip[3] << 8);
+    ip += 4;
+    #if MICROPY_PERSISTENT_CODE_XIP
+    const uint16_t *qstr_table = code_state->fun_bc->qstr_table;
+    if (qstr_table != NULL) {
+        *block_name = qstr_table[*block_name];
+        *source_file = qstr_table[*source_file];
+    }
+    #endif
+    #else
+    *block_name = mp_decode_uint_value(ip);
+    ip = mp_decode_uint_skip(ip);
+    *source_file = mp_decode_uint_value(ip);
+    ip = mp_decode_uint_skip(ip);
+    #endif
+    size_t line = 1;
+    size_t c;
+    while ((c = *ip)) {
+        size_t b, l;
+        if ((c & 0x80) == 0) {
+            // 0b0LLBBBBB encoding
+            b = c & 0x1f;
+            l = c >> 5;
+            ip += 1;
+        } else {
+            // 0b1LLLBBBB 0bLLLLLLLL encoding (l's LSB in second byte)
+            b = c & 0xf;
+            l = ((c << 4) & 0x700) | ip[1];
+            ip += 2;
+        }
+        if (bc >= b) {
+            bc -= b;
+            line += l;
+        } else {
+            // found source line corresponding to bytecode offset
+            break;
+        }
+    }
+    *source_line = line;
+}
+
 #if MICROPY_PERSISTENT_CODE_LOAD || MICROPY_PERSISTENT_CODE_SAVE
 
 // The following table encodes the number of bytes that a specific opcode
@@ -307,6 +363,12 @@ continue2:;
 //     MP_BC_LOAD_GLOBAL
 //     MP_BC_LOAD_ATTR
 //     MP_BC_STORE_ATTR
+// The superinstructions have the format of their first argument followed by
+// extra bytes:
+//     MP_BC_LOAD_FAST_ATTR, MP_BC_LOAD_FAST_METHOD: 1 byte
+//     MP_BC_BINARY_OP_FAST_SMALL_INT: 2 bytes
+//     MP_BC_BINARY_OP_FAST_FAST: 3 bytes
+//     MP_BC_FOR_ITER_UNPACK: 1 byte
 #define OC4(a, b, c, d) (a | (b << 2) | (c << 4) | (d << 6))
 #define U (0) // undefined opcode
 #define B (MP_OPCODE_BYTE) // single byte
@@ -332,8 +394,8 @@ STATIC const byte opcode_format_table[64] = {
     OC4(U, O, B, O), // 0x3c-0x3f
     OC4(O, B, B, O), // 0x40-0x43
     OC4(B, B, O, B), // 0x44-0x47
-    OC4(U, U, U, U), // 0x48-0x4b
-    OC4(U, U, U, U), // 0x4c-0x4f
+    OC4(Q, Q, B, V), // 0x48-0x4b
+    OC4(U, O, U, U), // 0x4c-0x4f
     OC4(V, V, U, V), // 0x50-0x53
     OC4(B, U, V, V), // 0x54-0x57
     OC4(V, V, V, B), // 0x58-0x5b
@@ -397,6 +459,9 @@ uint mp_opcode_format(const byte *ip, size_t *opcode_size) {
     const byte *ip_start = ip;
     if (f == MP_OPCODE_QSTR) {
         ip += 3;
+        if (*ip_start == MP_BC_LOAD_FAST_ATTR || *ip_start == MP_BC_LOAD_FAST_METHOD) {
+            ip += 1;
+        }
     } else {
         int extra_byte = (
             *ip == MP_BC_RAISE_VARARGS
@@ -409,6 +474,13 @@ uint mp_opcode_format(const byte *ip, size_t *opcode_size) {
             || *ip == MP_BC_STORE_ATTR
             #endif
         );
+        if (*ip == MP_BC_BINARY_OP_FAST_SMALL_INT) {
+            extra_byte = 2;
+        } else if (*ip == MP_BC_BINARY_OP_FAST_FAST) {
+            extra_byte = 3;
+        } else if (*ip == MP_BC_FOR_ITER_UNPACK) {
+            extra_byte = 1;
+        }
         ip += 1;
         if (f == MP_OPCODE_VAR_UINT) {
             while ((*ip++ & 0x80) != 0) {
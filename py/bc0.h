@@ -82,6 +82,13 @@
 #define MP_BC_UNWIND_JUMP        (0x46) // rel byte code offset, 16-bit signed, in excess; then a byte
 #define MP_BC_GET_ITER_STACK     (0x47)
 
+// Superinstructions, each doing the work of a common sequence of the above
+#define MP_BC_LOAD_FAST_ATTR           (0x48) // qstr, byte (LOAD_FAST_N; LOAD_ATTR)
+#define MP_BC_LOAD_FAST_METHOD         (0x49) // qstr, byte (LOAD_FAST_N; LOAD_METHOD)
+#define MP_BC_BINARY_OP_FAST_FAST      (0x4a) // byte, byte, byte (LOAD_FAST_N; LOAD_FAST_N; BINARY_OP)
+#define MP_BC_BINARY_OP_FAST_SMALL_INT (0x4b) // signed var-int, byte, byte (LOAD_FAST_N; LOAD_CONST_SMALL_INT; BINARY_OP)
+#define MP_BC_FOR_ITER_UNPACK          (0x4d) // rel byte code offset, 16-bit unsigned; then a byte (FOR_ITER; UNPACK_SEQUENCE)
+
 #define MP_BC_BUILD_TUPLE        (0x50) // uint
 #define MP_BC_BUILD_LIST         (0x51) // uint
 #define MP_BC_BUILD_MAP          (0x53) // uint
@@ -110,6 +117,30 @@
 #define MP_BC_IMPORT_FROM        (0x69) // qstr
 #define MP_BC_IMPORT_STAR        (0x6a)
 
+// Type-specialised forms of BINARY_OP_MULTI, LOAD_SUBSCR, FOR_ITER and the
+// binary op superinstructions.  With MICROPY_OPT_QUICKEN the VM writes these
+// over the generic opcode once it has seen the operand types, and writes the
+// generic opcode back when a guard fails.  They never appear in .mpy files.
+#define MP_BC_BINARY_OP_INT_ADD                (0x01)
+#define MP_BC_BINARY_OP_INT_SUBTRACT           (0x02)
+#define MP_BC_BINARY_OP_INT_INPLACE_ADD        (0x03)
+#define MP_BC_BINARY_OP_INT_INPLACE_SUBTRACT   (0x04)
+#define MP_BC_BINARY_OP_INT_LESS               (0x05)
+#define MP_BC_BINARY_OP_INT_MORE               (0x06)
+#define MP_BC_BINARY_OP_INT_LESS_EQUAL         (0x07)
+#define MP_BC_BINARY_OP_INT_MORE_EQUAL         (0x08)
+#define MP_BC_BINARY_OP_FLOAT_ADD              (0x09)
+#define MP_BC_BINARY_OP_FLOAT_SUBTRACT         (0x0a)
+#define MP_BC_BINARY_OP_FLOAT_MULTIPLY         (0x0b)
+#define MP_BC_BINARY_OP_FLOAT_INPLACE_ADD      (0x0c)
+#define MP_BC_BINARY_OP_FLOAT_INPLACE_SUBTRACT (0x0d)
+#define MP_BC_BINARY_OP_FLOAT_INPLACE_MULTIPLY (0x0e)
+#define MP_BC_LOAD_SUBSCR_LIST_INT             (0x2c)
+#define MP_BC_LOAD_SUBSCR_TUPLE_INT            (0x2d)
+#define MP_BC_FOR_ITER_RANGE                   (0x4c) // rel byte code offset, 16-bit unsigned
+#define MP_BC_BINARY_OP_FAST_FAST_INT          (0x4e) // byte, byte, byte
+#define MP_BC_BINARY_OP_FAST_SMALL_INT_INT     (0x4f) // signed var-int, byte, byte
+
 #define MP_BC_LOAD_CONST_SMALL_INT_MULTI (0x70) // + N(64)
 #define MP_BC_LOAD_FAST_MULTI            (0xb0) // + N(16)
 #define MP_BC_STORE_FAST_MULTI           (0xc0) // + N(16)
@@ -38,6 +38,15 @@
 #include "py/builtin.h"
 #include "py/frozenmod.h"
 
+#if MICROPY_MODULE_CACHE
+#include "py/stream.h"
+#if MICROPY_VFS
+#include "extmod/vfs.h"
+#elif MICROPY_READER_POSIX
+#include <sys/stat.h>
+#endif
+#endif
+
 #include "supervisor/shared/translate.h"
 
 #if MICROPY_DEBUG_VERBOSE // print debugging info
@@ -149,7 +158,11 @@ STATIC void do_load_from_lexer(mp_obj_t module_obj, mp_lexer_t *lex) {
 
     // parse, compile and execute the module in its context
     mp_obj_dict_t *mod_globals = mp_obj_module_get_globals(module_obj);
+    #if MICROPY_COMP_STREAMING
+    mp_parse_compile_execute_stream(lex, mod_globals, mod_globals);
+    #else
     mp_parse_compile_execute(lex, MP_PARSE_FILE_INPUT, mod_globals, mod_globals);
+    #endif
     mp_obj_module_set_globals(module_obj, make_dict_long_lived(mod_globals, 10));
 }
 #endif
@@ -191,6 +204,211 @@ STATIC void do_execute_raw_code(mp_obj_t module_obj, mp_raw_code_t *raw_code, co
 }
 #endif
 
+#if MICROPY_MODULE_CACHE
+// A cache file starts with a magic byte and the stamp of the source it was
+// compiled from, followed by the compiled code in .mpy format.  The stamp is
+// written last, so a cache file that was only partly written never matches.
+#define MODULE_CACHE_MAGIC 'C'
+#define MODULE_CACHE_STAMP_LEN (8)
+
+// Errors reading or writing a cache file are not reported, but anything that
+// isn't an Exception, such as KeyboardInterrupt, still is.
+STATIC void module_cache_check_error(void *exc) {
+    const mp_obj_type_t *type = ((mp_obj_base_t*)exc)->type;
+    if (!mp_obj_is_subclass_fast(MP_OBJ_FROM_PTR(type), MP_OBJ_FROM_PTR(&mp_type_Exception))) {
+        nlr_jump(exc);
+    }
+}
+
+// Store the size and modification time of the file at path in stamp, and
+// return whether it could be found.
+STATIC bool module_cache_stamp(const char *path, byte *stamp) {
+    mp_uint_t size, mtime;
+    #if MICROPY_VFS
+    // Only cache modules on native filesystems: a filesystem implemented in
+    // Python would see stat and open calls it never saw before.
+    const char *path_out;
+    mp_vfs_mount_t *vfs = mp_vfs_lookup_path(path, &path_out);
+    if (vfs == MP_VFS_NONE || vfs == MP_VFS_ROOT
+        || mp_proto_get(MP_QSTR_protocol_vfs, vfs->obj) == NULL) {
+        return false;
+    }
+    nlr_buf_t nlr;
+    if (nlr_push(&nlr) == 0) {
+        mp_obj_t *items;
+        mp_obj_get_array_fixed_n(mp_vfs_stat(mp_obj_new_str(path, strlen(path))), 10, &items);
+        size = mp_obj_get_int_truncated(items[6]);
+        mtime = mp_obj_get_int_truncated(items[8]);
+        nlr_pop();
+    } else {
+        module_cache_check_error(nlr.ret_val);
+        return false;
+    }
+    #elif MICROPY_READER_POSIX
+    struct stat st;
+    if (stat(path, &st) != 0) {
+        return false;
+    }
+    size = st.st_size;
+    mtime = st.st_mtime;
+    #else
+    #error MICROPY_MODULE_CACHE requires MICROPY_VFS or MICROPY_READER_POSIX
+    #endif
+    for (size_t i = 0; i < 4; ++i) {
+        stamp[i] = size >> (8 * i);
+        stamp[4 + i] = mtime >> (8 * i);
+    }
+    return true;
+}
+
+// Load the compiled code from the cache file at path if it holds code for the
+// source with the given stamp, else return NULL.
+STATIC mp_raw_code_t *module_cache_load(const char *path, const byte *stamp) {
+    if (mp_import_stat(path) != MP_IMPORT_STAT_FILE) {
+        return NULL;
+    }
+    mp_reader_t reader;
+    volatile bool opened = false;
+    nlr_buf_t nlr;
+    if (nlr_push(&nlr) == 0) {
+        mp_reader_new_file(&reader, path);
+        opened = true;
+        bool match = reader.readbyte(reader.data) == MODULE_CACHE_MAGIC;
+        for (size_t i = 0; match && i < MODULE_CACHE_STAMP_LEN; ++i) {
+            match = reader.readbyte(reader.data) == stamp[i];
+        }
+        mp_raw_code_t *rc = NULL;
+        if (match) {
+            // this closes the reader if it succeeds
+            rc = mp_raw_code_load(&reader);
+        } else {
+            reader.close(reader.data);
+        }
+        nlr_pop();
+        return rc;
+    } else {
+        // the cache file is unreadable, or was written by an incompatible
+        // version, so the source is compiled again
+        module_cache_check_error(nlr.ret_val);
+        if (opened) {
+            reader.close(reader.data);
+        }
+        return NULL;
+    }
+}
+
+// Open the cache file at path for writing, or return MP_OBJ_NULL if it can't
+// be written.
+STATIC mp_obj_t module_cache_open(const char *path) {
+    mp_obj_t args[2] = {mp_obj_new_str(path, strlen(path)), MP_OBJ_NEW_QSTR(MP_QSTR_wb)};
+    nlr_buf_t nlr;
+    if (nlr_push(&nlr) == 0) {
+        mp_obj_t file = mp_call_function_n_kw(MP_OBJ_FROM_PTR(&mp_builtin_open_obj), 2, 0, args);
+        nlr_pop();
+        return file;
+    } else {
+        module_cache_check_error(nlr.ret_val);
+        return MP_OBJ_NULL;
+    }
+}
+
+// Close a cache file, ignoring any error.
+STATIC void module_cache_close(mp_obj_t file) {
+    nlr_buf_t nlr;
+    if (nlr_push(&nlr) == 0) {
+        mp_stream_close(file);
+        nlr_pop();
+    } else {
+        module_cache_check_error(nlr.ret_val);
+    }
+}
+
+// Write to a cache file, raising an error unless all of buf was written: a
+// full filesystem can take part of a write without failing.
+STATIC void module_cache_write(void *file, const char *buf, size_t len) {
+    int errcode;
+    mp_uint_t out_sz = mp_stream_rw(MP_OBJ_FROM_PTR(file), (void*)buf, len, &errcode, MP_STREAM_RW_WRITE);
+    if (errcode != 0) {
+        mp_raise_OSError(errcode);
+    }
+    if (out_sz != len) {
+        mp_raise_OSError(MP_ENOSPC);
+    }
+}
+
+// Write rc, compiled from the source with the given stamp, to the cache file
+// opened by module_cache_open, and close it.  It must not have been run yet,
+// so that none of its bytecode has been quickened or had its inline caches
+// filled in.
+STATIC void module_cache_save(mp_raw_code_t *rc, mp_obj_t file, const byte *stamp) {
+    nlr_buf_t nlr;
+    if (nlr_push(&nlr) == 0) {
+        byte header[1 + MODULE_CACHE_STAMP_LEN] = {MODULE_CACHE_MAGIC};
+        module_cache_write(MP_OBJ_TO_PTR(file), (const char*)header, sizeof(header));
+        mp_print_t print = {MP_OBJ_TO_PTR(file), module_cache_write};
+        mp_raw_code_save(rc, &print);
+
+        // the code is complete and was all written, so stamp it
+        struct mp_stream_seek_t seek_s = {.offset = 1, .whence = MP_SEEK_SET};
+        int errcode;
+        if (mp_get_stream(file)->ioctl(file, MP_STREAM_SEEK, (uintptr_t)&seek_s, &errcode) == MP_STREAM_ERROR) {
+            mp_raise_OSError(errcode);
+        }
+        module_cache_write(MP_OBJ_TO_PTR(file), (const char*)stamp, MODULE_CACHE_STAMP_LEN);
+        nlr_pop();
+    } else {
+        module_cache_check_error(nlr.ret_val);
+    }
+    module_cache_close(file);
+}
+
+// Load the .py file named by file through its cache file (foo.py -> foo.mpc),
+// compiling it and writing the cache file if that doesn't match the source.
+STATIC void do_load_cached(mp_obj_t module_obj, vstr_t *file) {
+    char *file_str = vstr_null_terminated_str(file);
+    byte stamp[MODULE_CACHE_STAMP_LEN];
+    if (!module_cache_stamp(file_str, stamp)) {
+        do_load_from_lexer(module_obj, mp_lexer_new_from_file(file_str));
+        return;
+    }
+
+    vstr_t cache_path;
+    vstr_init(&cache_path, file->len + 2);
+    vstr_add_strn(&cache_path, file_str, file->len - 2);
+    vstr_add_str(&cache_path, "mpc");
+    const char *cache_str = vstr_null_terminated_str(&cache_path);
+
+    mp_raw_code_t *rc = module_cache_load(cache_str, stamp);
+    if (rc == NULL) {
+        mp_obj_t cache_file = module_cache_open(cache_str);
+        vstr_clear(&cache_path);
+        if (cache_file == MP_OBJ_NULL) {
+            // The whole module is only compiled at once so that it can be
+            // saved; without a cache file it can be streamed as usual.
+            do_load_from_lexer(module_obj, mp_lexer_new_from_file(file_str));
+            return;
+        }
+        nlr_buf_t nlr;
+        if (nlr_push(&nlr) == 0) {
+            mp_lexer_t *lex = mp_lexer_new_from_file(file_str);
+            qstr source_name = lex->source_name;
+            mp_parse_tree_t parse_tree = mp_parse(lex, MP_PARSE_FILE_INPUT);
+            rc = mp_compile_to_raw_code(&parse_tree, source_name, MP_EMIT_OPT_NONE, false);
+            nlr_pop();
+        } else {
+            // the cache file was left empty so it won't match next time
+            module_cache_close(cache_file);
+            nlr_jump(nlr.ret_val);
+        }
+        module_cache_save(rc, cache_file, stamp);
+    } else {
+        vstr_clear(&cache_path);
+    }
+
+    do_execute_raw_code(module_obj, rc, file_str);
+}
+#endif
+
 STATIC void do_load(mp_obj_t module_obj, vstr_t *file) {
     #if MICROPY_MODULE_FROZEN || MICROPY_PERSISTENT_CODE_LOAD || MICROPY_ENABLE_COMPILER
     char *file_str = vstr_null_terminated_str(file);
@@ -241,8 +459,12 @@ STATIC void do_load(mp_obj_t module_obj, vstr_t *file) {
     // If we can compile scripts then load the file and compile and execute it.
     #if MICROPY_ENABLE_COMPILER
     {
+        #if MICROPY_MODULE_CACHE
+        do_load_cached(module_obj, file);
+        #else
         mp_lexer_t *lex = mp_lexer_new_from_file(file_str);
         do_load_from_lexer(module_obj, lex);
+        #endif
         return;
     }
     #else
@@ -55,6 +55,7 @@
 #define MICROPY_COMP_CONST               (1)
 #define MICROPY_COMP_DOUBLE_TUPLE_ASSIGN (1)
 #define MICROPY_COMP_MODULE_CONST        (1)
+#define MICROPY_COMP_STREAMING           (1)
 #define MICROPY_COMP_TRIPLE_TUPLE_ASSIGN (0)
 #define MICROPY_DEBUG_PRINTERS           (0)
 #define MICROPY_EMIT_INLINE_THUMB        (CIRCUITPY_ENABLE_MPY_NATIVE)
@@ -68,13 +69,22 @@
 #define MICROPY_FLOAT_HIGH_QUALITY_HASH  (0)
 #define MICROPY_FLOAT_IMPL               (MICROPY_FLOAT_IMPL_FLOAT)
 #define MICROPY_GC_ALLOC_THRESHOLD       (0)
+#define MICROPY_GC_FREE_LIST_CACHE       (1)
+#define MICROPY_GC_INCREMENTAL_SWEEP     (1)
+#define MICROPY_GC_COMPACT               (1)
 #define MICROPY_HELPER_LEXER_UNIX        (0)
 #define MICROPY_HELPER_REPL              (1)
 #define MICROPY_KBD_EXCEPTION            (1)
 #define MICROPY_MEM_STATS                (0)
 #define MICROPY_NONSTANDARD_TYPECODES    (0)
 #define MICROPY_OPT_COMPUTED_GOTO        (1)
+#define MICROPY_OPT_FOR_ITER_INLINE      (1)
+#define MICROPY_OPT_LOAD_GLOBAL_CACHE    (1)
+#define MICROPY_OPT_MAP_LOOKUP_CACHE     (1)
+#define MICROPY_OPT_QUICKEN              (CIRCUITPY_FULL_BUILD)
+#define MICROPY_OPT_TYPE_ATTR_CACHE      (1)
 #define MICROPY_PERSISTENT_CODE_LOAD     (1)
+#define MICROPY_PERSISTENT_CODE_SAVE     (CIRCUITPY_FULL_BUILD)
 
 #define MICROPY_PY_ARRAY                 (1)
 #define MICROPY_PY_ARRAY_SLICE_ASSIGN    (1)
@@ -100,6 +110,7 @@
 #define MICROPY_PY_CMATH                 (0)
 #define MICROPY_PY_COLLECTIONS           (1)
 #define MICROPY_PY_DESCRIPTORS           (1)
+#define MICROPY_PY_SLOTS                 (CIRCUITPY_FULL_BUILD)
 #define MICROPY_PY_IO_FILEIO             (1)
 #define MICROPY_PY_GC                    (1)
 // Supplanted by shared-bindings/math
@@ -116,9 +127,11 @@
 #define MICROPY_PY___FILE__              (1)
 
 #define MICROPY_QSTR_BYTES_IN_HASH       (1)
+#define MICROPY_QSTR_HASH_INDEX          (CIRCUITPY_FULL_BUILD)
 #define MICROPY_REPL_AUTO_INDENT         (1)
 #define MICROPY_REPL_EVENT_DRIVEN        (0)
 #define MICROPY_STACK_CHECK              (1)
+#define MICROPY_ENABLE_PYSTACK           (1)
 #define MICROPY_STREAMS_NON_BLOCK        (1)
 #define MICROPY_USE_INTERNAL_PRINTF      (1)
 
@@ -139,6 +152,7 @@
 #define MICROPY_VFS                 (1)
 #define MICROPY_VFS_FAT             (MICROPY_VFS)
 #define MICROPY_READER_VFS          (MICROPY_VFS)
+#define MICROPY_READER_BUF_SIZE     (CIRCUITPY_FULL_BUILD ? FILESYSTEM_BLOCK_SIZE : 64)
 
 // type definitions for the specific machine
 
@@ -183,6 +197,7 @@ typedef long mp_off_t;
 // Remove some lesser-used functionality to make small builds fit.
 #define MICROPY_BUILTIN_METHOD_CHECK_SELF_ARG (CIRCUITPY_FULL_BUILD)
 #define MICROPY_CPYTHON_COMPAT                (CIRCUITPY_FULL_BUILD)
+#define MICROPY_MODULE_CACHE                  (CIRCUITPY_FULL_BUILD)
 #define MICROPY_MODULE_WEAK_LINKS             (CIRCUITPY_FULL_BUILD)
 #define MICROPY_PY_ALL_SPECIAL_METHODS        (CIRCUITPY_FULL_BUILD)
 #define MICROPY_PY_BUILTINS_COMPLEX           (CIRCUITPY_FULL_BUILD)
@@ -687,6 +702,12 @@ void supervisor_run_background_tasks_if_tick(void);
 #define CIRCUITPY_FILESYSTEM_FLUSH_INTERVAL_MS 1000
 #endif
 
+// Bytes set aside by the supervisor for Python function call frames, separate
+// from the GC heap. Deeper recursion raises RuntimeError('pystack exhausted').
+#ifndef CIRCUITPY_PYSTACK_SIZE
+#define CIRCUITPY_PYSTACK_SIZE 1536
+#endif
+
 #define CIRCUITPY_BOOT_OUTPUT_FILE "/boot_out.txt"
 
 #define CIRCUITPY_VERBOSE_BLE 0
@@ -138,6 +138,8 @@ typedef struct _compiler_t {
     scope_t *scope_head;
     scope_t *scope_cur;
 
+    m_arena_t arena; // holds the scopes and bytecode emitter until compiling is done
+
     emit_t *emit;                                   // current emitter
     #if NEED_METHOD_TABLE
     const emit_method_table_t *emit_method_table;   // current emit method table
@@ -185,7 +187,7 @@ STATIC void compile_decrease_except_level(compiler_t *comp) {
 }
 
 STATIC scope_t *scope_new_and_link(compiler_t *comp, scope_kind_t kind, mp_parse_node_t pn, uint emit_options) {
-    scope_t *scope = scope_new(kind, pn, comp->source_file, emit_options);
+    scope_t *scope = scope_new(&comp->arena, kind, pn, comp->source_file, emit_options);
     scope->parent = comp->scope_cur;
     scope->next = NULL;
     if (comp->scope_head == NULL) {
@@ -3348,12 +3350,13 @@ mp_raw_code_t *mp_compile_to_raw_code(mp_parse_tree_t *parse_tree, qstr source_f
     comp->is_repl = is_repl;
     comp->break_label = INVALID_LABEL;
     comp->continue_label = INVALID_LABEL;
+    m_arena_init(&comp->arena);
 
     // create the module scope
     scope_t *module_scope = scope_new_and_link(comp, SCOPE_MODULE, parse_tree->root, emit_opt);
 
     // create standard emitter; it's used at least for MP_PASS_SCOPE
-    emit_t *emit_bc = emit_bc_new();
+    emit_t *emit_bc = emit_bc_new(&comp->arena);
 
     // compile pass 1
     comp->emit = emit_bc;
@@ -3383,7 +3386,7 @@ mp_raw_code_t *mp_compile_to_raw_code(mp_parse_tree_t *parse_tree, qstr source_f
     }
 
     // set max number of labels now that it's calculated
-    emit_bc_set_max_num_labels(emit_bc, max_num_labels);
+    emit_bc_set_max_num_labels(emit_bc, max_num_labels, &comp->arena);
 
     // compile pass 2 and 3
 #if MICROPY_EMIT_NATIVE
@@ -3463,9 +3466,7 @@ mp_raw_code_t *mp_compile_to_raw_code(mp_parse_tree_t *parse_tree, qstr source_f
             comp->compile_error_line, comp->scope_cur->simple_name);
     }
 
-    // free the emitters
-
-    emit_bc_free(emit_bc);
+    // free the native and inline asm emitters
 #if MICROPY_EMIT_NATIVE
     if (emit_native != NULL) {
         NATIVE_EMITTER(free)(emit_native);
@@ -3480,13 +3481,9 @@ mp_raw_code_t *mp_compile_to_raw_code(mp_parse_tree_t *parse_tree, qstr source_f
     // free the parse tree
     mp_parse_tree_clear(parse_tree);
 
-    // free the scopes
+    // free the scopes and the bytecode emitter in one go
     mp_raw_code_t *outer_raw_code = module_scope->raw_code;
-    for (scope_t *s = module_scope; s;) {
-        scope_t *next = s->next;
-        scope_free(s);
-        s = next;
-    }
+    m_arena_free(&comp->arena);
 
     if (comp->compile_error != MP_OBJ_NULL) {
         nlr_raise(comp->compile_error);
@@ -39,6 +39,19 @@
 #define BYTES_FOR_INT ((BYTES_PER_WORD * 8 + 6) / 7)
 #define DUMMY_DATA_SIZE (BYTES_FOR_INT)
 
+// Kinds of opcode that may be fused with the following opcode
+#define FUSE_NONE (0)
+#define FUSE_LOAD_FAST (1)
+#define FUSE_LOAD_SMALL_INT (2)
+#define FUSE_FOR_ITER (3)
+
+typedef struct _emit_fuse_t {
+    size_t start; // bytecode offset of the opcode
+    size_t end; // bytecode offset just after the opcode
+    mp_int_t arg; // local number, small int or label
+    byte kind;
+} emit_fuse_t;
+
 struct _emit_t {
     // Accessed as mp_obj_t, so must be aligned as such, and we rely on the
     // memory allocator returning a suitably aligned pointer.
@@ -58,6 +71,9 @@ struct _emit_t {
     mp_uint_t max_num_labels;
     mp_uint_t *label_offsets;
 
+    // the last two fusable opcodes, oldest first
+    emit_fuse_t fuse[2];
+
     size_t code_info_offset;
     size_t code_info_size;
     size_t bytecode_offset;
@@ -72,19 +88,14 @@ struct _emit_t {
     mp_uint_t *const_table;
 };
 
-emit_t *emit_bc_new(void) {
-    emit_t *emit = m_new0(emit_t, 1);
+emit_t *emit_bc_new(m_arena_t *arena) {
+    emit_t *emit = m_arena_new(arena, emit_t, 1);
     return emit;
 }
 
-void emit_bc_set_max_num_labels(emit_t *emit, mp_uint_t max_num_labels) {
+void emit_bc_set_max_num_labels(emit_t *emit, mp_uint_t max_num_labels, m_arena_t *arena) {
     emit->max_num_labels = max_num_labels;
-    emit->label_offsets = m_new(mp_uint_t, emit->max_num_labels);
-}
-
-void emit_bc_free(emit_t *emit) {
-    m_del(mp_uint_t, emit->label_offsets, emit->max_num_labels);
-    m_del_obj(emit_t, emit);
+    emit->label_offsets = m_arena_new(arena, mp_uint_t, emit->max_num_labels);
 }
 
 typedef byte *(*emit_allocator_t)(emit_t *emit, int nbytes);
@@ -306,6 +317,50 @@ STATIC void emit_write_bytecode_byte_signed_label(emit_t *emit, byte b1, mp_uint
     c[2] = bytecode_offset >> 8;
 }
 
+// Superinstructions: loads of locals and small ints are remembered so that an
+// opcode emitted straight after them can rewind the bytecode and replace the
+// whole sequence with one opcode.  Labels and source line changes between the
+// loads and the opcode prevent this, so no jump or line number can point into
+// a fused sequence.  The same choices are made on every pass, so the code size
+// stays the same.
+
+STATIC void emit_bc_fuse_reset(emit_t *emit) {
+    emit->fuse[0].kind = FUSE_NONE;
+    emit->fuse[1].kind = FUSE_NONE;
+}
+
+STATIC void emit_bc_fuse_note(emit_t *emit, byte kind, size_t start, mp_int_t arg) {
+    emit->fuse[0] = emit->fuse[1];
+    emit->fuse[1].start = start;
+    emit->fuse[1].end = emit->bytecode_offset;
+    emit->fuse[1].arg = arg;
+    emit->fuse[1].kind = kind;
+}
+
+// Number of the remembered loads that immediately precede the next opcode
+STATIC size_t emit_bc_fuse_count(emit_t *emit) {
+    if (emit->fuse[1].kind == FUSE_NONE || emit->fuse[1].end != emit->bytecode_offset) {
+        return 0;
+    }
+    if (emit->fuse[0].kind == FUSE_NONE || emit->fuse[0].end != emit->fuse[1].start) {
+        return 1;
+    }
+    return 2;
+}
+
+// Emit a superinstruction in place of a load of a local and then op
+STATIC bool emit_bc_fuse_load_fast_qstr(emit_t *emit, byte op, qstr qst) {
+    if (emit_bc_fuse_count(emit) < 1 || emit->fuse[1].kind != FUSE_LOAD_FAST) {
+        return false;
+    }
+    byte local_num = emit->fuse[1].arg;
+    emit->bytecode_offset = emit->fuse[1].start;
+    emit_bc_fuse_reset(emit);
+    emit_write_bytecode_byte_qstr(emit, op, qst);
+    emit_write_bytecode_byte(emit, local_num);
+    return true;
+}
+
 void mp_emit_bc_start_pass(emit_t *emit, pass_kind_t pass, scope_t *scope) {
     emit->pass = pass;
     emit->stack_size = 0;
@@ -321,6 +376,7 @@ void mp_emit_bc_start_pass(emit_t *emit, pass_kind_t pass, scope_t *scope) {
     #endif
     emit->bytecode_offset = 0;
     emit->code_info_offset = 0;
+    emit_bc_fuse_reset(emit);
 
     // Write local state size and exception stack size.
     {
@@ -481,6 +537,7 @@ void mp_emit_bc_set_source_line(emit_t *emit, mp_uint_t source_line) {
         emit_write_code_info_bytes_lines(emit, bytes_to_skip, lines_to_skip);
         emit->last_source_line_offset = emit->bytecode_offset;
         emit->last_source_line = source_line;
+        emit_bc_fuse_reset(emit);
     }
 #else
     (void)emit;
@@ -493,6 +550,7 @@ void mp_emit_bc_label_assign(emit_t *emit, mp_uint_t l) {
     if (emit->pass == MP_PASS_SCOPE) {
         return;
     }
+    emit_bc_fuse_reset(emit);
     assert(l < emit->max_num_labels);
     if (emit->pass < MP_PASS_EMIT) {
         // assign label offset
@@ -534,11 +592,13 @@ void mp_emit_bc_load_const_tok(emit_t *emit, mp_token_kind_t tok) {
 
 void mp_emit_bc_load_const_small_int(emit_t *emit, mp_int_t arg) {
     emit_bc_pre(emit, 1);
+    size_t start = emit->bytecode_offset;
     if (-16 <= arg && arg <= 47) {
         emit_write_bytecode_byte(emit, MP_BC_LOAD_CONST_SMALL_INT_MULTI + 16 + arg);
     } else {
         emit_write_bytecode_byte_int(emit, MP_BC_LOAD_CONST_SMALL_INT, arg);
     }
+    emit_bc_fuse_note(emit, FUSE_LOAD_SMALL_INT, start, arg);
 }
 
 void mp_emit_bc_load_const_str(emit_t *emit, qstr qst) {
@@ -561,11 +621,15 @@ void mp_emit_bc_load_local(emit_t *emit, qstr qst, mp_uint_t local_num, int kind
     MP_STATIC_ASSERT(MP_BC_LOAD_FAST_N + MP_EMIT_IDOP_LOCAL_DEREF == MP_BC_LOAD_DEREF);
     (void)qst;
     emit_bc_pre(emit, 1);
+    size_t start = emit->bytecode_offset;
     if (kind == MP_EMIT_IDOP_LOCAL_FAST && local_num <= 15) {
         emit_write_bytecode_byte(emit, MP_BC_LOAD_FAST_MULTI + local_num);
     } else {
         emit_write_bytecode_byte_uint(emit, MP_BC_LOAD_FAST_N + kind, local_num);
     }
+    if (kind == MP_EMIT_IDOP_LOCAL_FAST && local_num <= 255) {
+        emit_bc_fuse_note(emit, FUSE_LOAD_FAST, start, local_num);
+    }
 }
 
 void mp_emit_bc_load_global(emit_t *emit, qstr qst, int kind) {
@@ -581,6 +645,9 @@ void mp_emit_bc_load_global(emit_t *emit, qstr qst, int kind) {
 
 void mp_emit_bc_load_method(emit_t *emit, qstr qst, bool is_super) {
     emit_bc_pre(emit, 1 - 2 * is_super);
+    if (!is_super && emit_bc_fuse_load_fast_qstr(emit, MP_BC_LOAD_FAST_METHOD, qst)) {
+        return;
+    }
     emit_write_bytecode_byte_qstr(emit, is_super ? MP_BC_LOAD_SUPER_METHOD : MP_BC_LOAD_METHOD, qst);
 }
 
@@ -606,6 +673,11 @@ void mp_emit_bc_subscr(emit_t *emit, int kind) {
 void mp_emit_bc_attr(emit_t *emit, qstr qst, int kind) {
     if (kind == MP_EMIT_ATTR_LOAD) {
         emit_bc_pre(emit, 0);
+        // a LOAD_ATTR with a cache byte is faster on instances than the fused form
+        if (!MICROPY_OPT_CACHE_MAP_LOOKUP_IN_BYTECODE_DYNAMIC
+            && emit_bc_fuse_load_fast_qstr(emit, MP_BC_LOAD_FAST_ATTR, qst)) {
+            return;
+        }
         emit_write_bytecode_byte_qstr(emit, MP_BC_LOAD_ATTR, qst);
     } else {
         if (kind == MP_EMIT_ATTR_DELETE) {
@@ -754,7 +826,9 @@ void mp_emit_bc_get_iter(emit_t *emit, bool use_stack) {
 
 void mp_emit_bc_for_iter(emit_t *emit, mp_uint_t label) {
     emit_bc_pre(emit, 1);
+    size_t start = emit->bytecode_offset;
     emit_write_bytecode_byte_unsigned_label(emit, MP_BC_FOR_ITER, label);
+    emit_bc_fuse_note(emit, FUSE_FOR_ITER, start, label);
 }
 
 void mp_emit_bc_for_iter_end(emit_t *emit) {
@@ -786,7 +860,26 @@ void mp_emit_bc_binary_op(emit_t *emit, mp_binary_op_t op) {
         op = MP_BINARY_OP_IS;
     }
     emit_bc_pre(emit, -1);
-    emit_write_bytecode_byte(emit, MP_BC_BINARY_OP_MULTI + op);
+    if (emit_bc_fuse_count(emit) == 2 && emit->fuse[0].kind == FUSE_LOAD_FAST
+        && emit->fuse[1].kind != FUSE_FOR_ITER) {
+        // replace the loads of the operands
+        emit_fuse_t lhs = emit->fuse[0];
+        emit_fuse_t rhs = emit->fuse[1];
+        emit->bytecode_offset = lhs.start;
+        emit_bc_fuse_reset(emit);
+        if (rhs.kind == FUSE_LOAD_FAST) {
+            byte *c = emit_get_cur_to_write_bytecode(emit, 4);
+            c[0] = MP_BC_BINARY_OP_FAST_FAST;
+            c[1] = lhs.arg;
+            c[2] = rhs.arg;
+            c[3] = op;
+        } else {
+            emit_write_bytecode_byte_int(emit, MP_BC_BINARY_OP_FAST_SMALL_INT, rhs.arg);
+            emit_write_bytecode_byte_byte(emit, lhs.arg, op);
+        }
+    } else {
+        emit_write_bytecode_byte(emit, MP_BC_BINARY_OP_MULTI + op);
+    }
     if (invert) {
         emit_bc_pre(emit, 0);
         emit_write_bytecode_byte(emit, MP_BC_UNARY_OP_MULTI + MP_UNARY_OP_NOT);
@@ -832,7 +925,16 @@ void mp_emit_bc_store_comp(emit_t *emit, scope_kind_t kind, mp_uint_t collection
 
 void mp_emit_bc_unpack_sequence(emit_t *emit, mp_uint_t n_args) {
     emit_bc_pre(emit, -1 + n_args);
-    emit_write_bytecode_byte_uint(emit, MP_BC_UNPACK_SEQUENCE, n_args);
+    if (emit_bc_fuse_count(emit) >= 1 && emit->fuse[1].kind == FUSE_FOR_ITER && n_args <= 255) {
+        // for a, b in ...: the VM can store the values without making a tuple
+        mp_uint_t label = emit->fuse[1].arg;
+        emit->bytecode_offset = emit->fuse[1].start;
+        emit_bc_fuse_reset(emit);
+        emit_write_bytecode_byte_unsigned_label(emit, MP_BC_FOR_ITER_UNPACK, label);
+        emit_write_bytecode_byte(emit, n_args);
+    } else {
+        emit_write_bytecode_byte_uint(emit, MP_BC_UNPACK_SEQUENCE, n_args);
+    }
 }
 
 void mp_emit_bc_unpack_ex(emit_t *emit, mp_uint_t n_left, mp_uint_t n_right) {
@@ -47,6 +47,10 @@ typedef struct _mp_raw_code_t {
         struct {
             const byte *bytecode;
             const mp_uint_t *const_table;
+            #if MICROPY_PERSISTENT_CODE_XIP
+            // Non-NULL if the qstrs in the bytecode are module-local indices
+            const uint16_t *qstr_table;
+            #endif
             #if MICROPY_PERSISTENT_CODE_SAVE
             mp_uint_t bc_len;
             uint16_t n_obj;
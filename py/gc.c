@@ -29,6 +29,8 @@
 #include <string.h>
 
 #include "py/gc.h"
+#include "py/objarray.h"
+#include "py/objlist.h"
 #include "py/runtime.h"
 
 #include "supervisor/shared/safe_mode.h"
@@ -74,6 +76,21 @@
 #define ATB_HEAD_TO_MARK(block) do { MP_STATE_MEM(gc_alloc_table_start)[(block) / BLOCKS_PER_ATB] |= (AT_MARK << BLOCK_SHIFT(block)); } while (0)
 #define ATB_MARK_TO_HEAD(block) do { MP_STATE_MEM(gc_alloc_table_start)[(block) / BLOCKS_PER_ATB] &= (~(AT_TAIL << BLOCK_SHIFT(block))); } while (0)
 
+// Outside of a collection, heads are only marked while an incremental sweep
+// hasn't reached them yet.
+#if MICROPY_GC_INCREMENTAL_SWEEP
+#define ATB_IS_HEAD(block) (ATB_GET_KIND(block) == AT_HEAD || ATB_GET_KIND(block) == AT_MARK)
+#else
+#define ATB_IS_HEAD(block) (ATB_GET_KIND(block) == AT_HEAD)
+#endif
+
+// Word-at-a-time view of the ATB, used to skip quickly over runs of free or used blocks.
+// ATB_FREE_PAIRS sets the low bit of every 2-bit entry of a that is AT_FREE.
+#define BLOCKS_PER_WORD (BLOCKS_PER_ATB * BYTES_PER_WORD)
+#define ATB_PAIRS_LOW_WORD ((mp_uint_t)-1 / 3)
+#define ATB_PAIRS_LOW_BYTE (0x55)
+#define ATB_FREE_PAIRS(a, mask) (~((a) | ((a) >> 1)) & (mask))
+
 #define BLOCK_FROM_PTR(ptr) (((byte*)(ptr) - MP_STATE_MEM(gc_pool_start)) / BYTES_PER_BLOCK)
 #define PTR_FROM_BLOCK(block) (((block) * BYTES_PER_BLOCK + (uintptr_t)MP_STATE_MEM(gc_pool_start)))
 #define ATB_FROM_BLOCK(bl) ((bl) / BLOCKS_PER_ATB)
@@ -89,6 +106,16 @@
 #define FTB_CLEAR(block) do { MP_STATE_MEM(gc_finaliser_table_start)[(block) / BLOCKS_PER_FTB] &= (~(1 << ((block) & 7))); } while (0)
 #endif
 
+// OTB = overflow table byte
+// if set, then the corresponding block has been marked but couldn't be pushed
+// on the mark stack, so its children still have to be traced
+
+#define BLOCKS_PER_OTB (8)
+
+#define OTB_GET(block) ((MP_STATE_MEM(gc_overflow_table_start)[(block) / BLOCKS_PER_OTB] >> ((block) & 7)) & 1)
+#define OTB_SET(block) do { MP_STATE_MEM(gc_overflow_table_start)[(block) / BLOCKS_PER_OTB] |= (1 << ((block) & 7)); } while (0)
+#define OTB_CLEAR(block) do { MP_STATE_MEM(gc_overflow_table_start)[(block) / BLOCKS_PER_OTB] &= (~(1 << ((block) & 7))); } while (0)
+
 #if MICROPY_PY_THREAD && !MICROPY_PY_THREAD_GIL
 #define GC_ENTER() mp_thread_mutex_lock(&MP_STATE_MEM(gc_mutex), 1)
 #define GC_EXIT() mp_thread_mutex_unlock(&MP_STATE_MEM(gc_mutex))
@@ -108,22 +135,117 @@ void __attribute__ ((noinline)) gc_log_change(uint32_t start_block, uint32_t len
 #pragma GCC pop_options
 #endif
 
+#if MICROPY_GC_FREE_LIST_CACHE
+STATIC void gc_free_list_reset(void) {
+    for (size_t c = 0; c < MICROPY_GC_FREE_LIST_CLASSES; c++) {
+        MP_STATE_MEM(gc_free_list_next)[c] = 0;
+        MP_STATE_MEM(gc_free_list_len)[c] = 0;
+        MP_STATE_MEM(gc_free_list_scan)[c] = 0;
+    }
+}
+
+// Record a run of free blocks found by gc_sweep, split into entries for each
+// size class that still has room. Runs that reach into the long lived section
+// are clipped so that short lived objects stay at the start of the heap.
+STATIC void gc_free_list_add_run(size_t start, size_t len) {
+    size_t crossover_block = BLOCK_FROM_PTR(MP_STATE_MEM(gc_lowest_long_lived_ptr));
+    if (start >= crossover_block) {
+        return;
+    }
+    if (start + len > crossover_block) {
+        len = crossover_block - start;
+    }
+    for (size_t c = 0; c < MICROPY_GC_FREE_LIST_CLASSES; c++) {
+        if (MP_STATE_MEM(gc_free_list_len)[c] == MICROPY_GC_FREE_LIST_LEN) {
+            continue;
+        }
+        size_t n = c + 1;
+        size_t bl = start;
+        for (; bl + n <= start + len && MP_STATE_MEM(gc_free_list_len)[c] < MICROPY_GC_FREE_LIST_LEN; bl += n) {
+            MP_STATE_MEM(gc_free_list)[c][MP_STATE_MEM(gc_free_list_len)[c]++] = bl;
+        }
+        // Remember where to carry on from once these entries are used up.
+        MP_STATE_MEM(gc_free_list_scan)[c] = MP_STATE_MEM(gc_free_list_len)[c] == MICROPY_GC_FREE_LIST_LEN ? bl : start + len;
+    }
+}
+
+// Refill the entries of a size class by scanning the ATB onwards from where
+// the last refill stopped. The scan position only moves forward between
+// sweeps, so each block is visited at most once per collection.
+STATIC void gc_free_list_refill(size_t c, size_t limit) {
+    size_t n = c + 1;
+    size_t count = 0;
+    size_t run = 0;
+    size_t bl = MP_STATE_MEM(gc_free_list_scan)[c];
+    for (; bl < limit && count < MICROPY_GC_FREE_LIST_LEN; bl++) {
+        if (ATB_GET_KIND(bl) != AT_FREE) {
+            run = 0;
+        } else if (++run == n) {
+            MP_STATE_MEM(gc_free_list)[c][count++] = bl + 1 - n;
+            run = 0;
+        }
+    }
+    MP_STATE_MEM(gc_free_list_scan)[c] = bl;
+    MP_STATE_MEM(gc_free_list_next)[c] = 0;
+    MP_STATE_MEM(gc_free_list_len)[c] = count;
+}
+
+// Pop the first cached run of n_blocks that is still free. Entries may have
+// been used since they were recorded (by a scan, a realloc or another size
+// class), so the ATB is checked before an entry is handed out.
+STATIC size_t gc_free_list_pop(size_t n_blocks) {
+    size_t c = n_blocks - 1;
+    size_t crossover_block = BLOCK_FROM_PTR(MP_STATE_MEM(gc_lowest_long_lived_ptr));
+    size_t limit = crossover_block;
+    #if MICROPY_GC_INCREMENTAL_SWEEP
+    // Don't refill from blocks a pending sweep hasn't reached yet.
+    if (MP_STATE_MEM(gc_sweep_block) < limit) {
+        limit = MP_STATE_MEM(gc_sweep_block);
+    }
+    #endif
+    for (;;) {
+        if (MP_STATE_MEM(gc_free_list_next)[c] == MP_STATE_MEM(gc_free_list_len)[c]) {
+            if (MP_STATE_MEM(gc_free_list_scan)[c] >= limit) {
+                return (size_t)-1;
+            }
+            gc_free_list_refill(c, limit);
+            if (MP_STATE_MEM(gc_free_list_len)[c] == 0) {
+                return (size_t)-1;
+            }
+        }
+        size_t block = MP_STATE_MEM(gc_free_list)[c][MP_STATE_MEM(gc_free_list_next)[c]++];
+        if (block + n_blocks > crossover_block) {
+            continue;
+        }
+        size_t n = 0;
+        while (n < n_blocks && ATB_GET_KIND(block + n) == AT_FREE) {
+            n++;
+        }
+        if (n == n_blocks) {
+            return block;
+        }
+    }
+}
+#endif
+
 // TODO waste less memory; currently requires that all entries in alloc_table have a corresponding block in pool
 void gc_init(void *start, void *end) {
     // align end pointer on block boundary
     end = (void*)((uintptr_t)end & (~(BYTES_PER_BLOCK - 1)));
     DEBUG_printf("Initializing GC heap: %p..%p = " UINT_FMT " bytes\n", start, end, (byte*)end - (byte*)start);
 
-    // calculate parameters for GC (T=total, A=alloc table, F=finaliser table, P=pool; all in bytes):
-    // T = A + F + P
+    // calculate parameters for GC (T=total, A=alloc table, F=finaliser table, O=overflow table, P=pool; all in bytes):
+    // T = A + F + O + P
     //     F = A * BLOCKS_PER_ATB / BLOCKS_PER_FTB
+    //     O = A * BLOCKS_PER_ATB / BLOCKS_PER_OTB
     //     P = A * BLOCKS_PER_ATB * BYTES_PER_BLOCK
-    // => T = A * (1 + BLOCKS_PER_ATB / BLOCKS_PER_FTB + BLOCKS_PER_ATB * BYTES_PER_BLOCK)
+    // => T = A * (1 + BLOCKS_PER_ATB / BLOCKS_PER_FTB + BLOCKS_PER_ATB / BLOCKS_PER_OTB + BLOCKS_PER_ATB * BYTES_PER_BLOCK)
     size_t total_byte_len = (byte*)end - (byte*)start;
 #if MICROPY_ENABLE_FINALISER
-    MP_STATE_MEM(gc_alloc_table_byte_len) = total_byte_len * BITS_PER_BYTE / (BITS_PER_BYTE + BITS_PER_BYTE * BLOCKS_PER_ATB / BLOCKS_PER_FTB + BITS_PER_BYTE * BLOCKS_PER_ATB * BYTES_PER_BLOCK);
+    // F and O are each rounded up to a whole byte, so leave a byte for that.
+    MP_STATE_MEM(gc_alloc_table_byte_len) = (total_byte_len - 1) * BITS_PER_BYTE / (BITS_PER_BYTE + BITS_PER_BYTE * BLOCKS_PER_ATB / BLOCKS_PER_FTB + BITS_PER_BYTE * BLOCKS_PER_ATB / BLOCKS_PER_OTB + BITS_PER_BYTE * BLOCKS_PER_ATB * BYTES_PER_BLOCK);
 #else
-    MP_STATE_MEM(gc_alloc_table_byte_len) = total_byte_len / (1 + BITS_PER_BYTE / 2 * BYTES_PER_BLOCK);
+    MP_STATE_MEM(gc_alloc_table_byte_len) = total_byte_len * BITS_PER_BYTE / (BITS_PER_BYTE + BITS_PER_BYTE * BLOCKS_PER_ATB / BLOCKS_PER_OTB + BITS_PER_BYTE * BLOCKS_PER_ATB * BYTES_PER_BLOCK);
 #endif
 
     MP_STATE_MEM(gc_alloc_table_start) = (byte*)start;
@@ -131,15 +253,17 @@ void gc_init(void *start, void *end) {
 #if MICROPY_ENABLE_FINALISER
     size_t gc_finaliser_table_byte_len = (MP_STATE_MEM(gc_alloc_table_byte_len) * BLOCKS_PER_ATB + BLOCKS_PER_FTB - 1) / BLOCKS_PER_FTB;
     MP_STATE_MEM(gc_finaliser_table_start) = MP_STATE_MEM(gc_alloc_table_start) + MP_STATE_MEM(gc_alloc_table_byte_len);
+    MP_STATE_MEM(gc_overflow_table_start) = MP_STATE_MEM(gc_finaliser_table_start) + gc_finaliser_table_byte_len;
+#else
+    MP_STATE_MEM(gc_overflow_table_start) = MP_STATE_MEM(gc_alloc_table_start) + MP_STATE_MEM(gc_alloc_table_byte_len);
 #endif
+    size_t gc_overflow_table_byte_len = (MP_STATE_MEM(gc_alloc_table_byte_len) * BLOCKS_PER_ATB + BLOCKS_PER_OTB - 1) / BLOCKS_PER_OTB;
 
     size_t gc_pool_block_len = MP_STATE_MEM(gc_alloc_table_byte_len) * BLOCKS_PER_ATB;
     MP_STATE_MEM(gc_pool_start) = (byte*)end - gc_pool_block_len * BYTES_PER_BLOCK;
     MP_STATE_MEM(gc_pool_end) = end;
 
-#if MICROPY_ENABLE_FINALISER
-    assert(MP_STATE_MEM(gc_pool_start) >= MP_STATE_MEM(gc_finaliser_table_start) + gc_finaliser_table_byte_len);
-#endif
+    assert(MP_STATE_MEM(gc_pool_start) >= MP_STATE_MEM(gc_overflow_table_start) + gc_overflow_table_byte_len);
 
     // clear ATBs
     memset(MP_STATE_MEM(gc_alloc_table_start), 0, MP_STATE_MEM(gc_alloc_table_byte_len));
@@ -149,6 +273,13 @@ void gc_init(void *start, void *end) {
     memset(MP_STATE_MEM(gc_finaliser_table_start), 0, gc_finaliser_table_byte_len);
 #endif
 
+    // clear OTBs
+    memset(MP_STATE_MEM(gc_overflow_table_start), 0, gc_overflow_table_byte_len);
+
+    #if MICROPY_GC_FREE_LIST_CACHE
+    gc_free_list_reset();
+    #endif
+
     // Set first free ATB index to the start of the heap.
     MP_STATE_MEM(gc_first_free_atb_index) = 0;
     // Set last free ATB index to the end of the heap.
@@ -157,6 +288,11 @@ void gc_init(void *start, void *end) {
     // lived objects are allocated.
     MP_STATE_MEM(gc_lowest_long_lived_ptr) = (void*) PTR_FROM_BLOCK(MP_STATE_MEM(gc_alloc_table_byte_len * BLOCKS_PER_ATB));
 
+    #if MICROPY_GC_INCREMENTAL_SWEEP
+    // No sweep is pending.
+    MP_STATE_MEM(gc_sweep_block) = gc_pool_block_len;
+    #endif
+
     // unlock the GC
     MP_STATE_MEM(gc_lock_depth) = 0;
 
@@ -180,6 +316,7 @@ void gc_init(void *start, void *end) {
 #if MICROPY_ENABLE_FINALISER
     DEBUG_printf("  finaliser table at %p, length " UINT_FMT " bytes, " UINT_FMT " blocks\n", MP_STATE_MEM(gc_finaliser_table_start), gc_finaliser_table_byte_len, gc_finaliser_table_byte_len * BLOCKS_PER_FTB);
 #endif
+    DEBUG_printf("  overflow table at %p, length " UINT_FMT " bytes, " UINT_FMT " blocks\n", MP_STATE_MEM(gc_overflow_table_start), gc_overflow_table_byte_len, gc_overflow_table_byte_len * BLOCKS_PER_OTB);
     DEBUG_printf("  pool at %p, length " UINT_FMT " bytes, " UINT_FMT " blocks\n", MP_STATE_MEM(gc_pool_start), gc_pool_block_len * BYTES_PER_BLOCK, gc_pool_block_len);
 }
 
@@ -206,6 +343,24 @@ bool gc_is_locked(void) {
     return MP_STATE_MEM(gc_lock_depth) != 0;
 }
 
+#if MICROPY_GC_COMPACT
+// While gc_compact is collecting, count the references to each block, up to
+// two, using two bits per block laid out like the ATB.
+STATIC void gc_compact_count_ref(size_t block) {
+    byte *refs = MP_STATE_MEM(gc_compact_refs);
+    byte *b = &refs[block / BLOCKS_PER_ATB];
+    size_t shift = (block & (BLOCKS_PER_ATB - 1)) * 2;
+    if (((*b >> shift) & 3) < 2) {
+        *b += 1 << shift;
+    }
+}
+#define GC_COMPACT_REFS(block) ((MP_STATE_MEM(gc_compact_refs)[(block) / BLOCKS_PER_ATB] >> (((block) & (BLOCKS_PER_ATB - 1)) * 2)) & 3)
+#define GC_COMPACT_PIN(block) (MP_STATE_MEM(gc_compact_refs)[(block) / BLOCKS_PER_ATB] |= 3 << (((block) & (BLOCKS_PER_ATB - 1)) * 2))
+#define GC_COMPACT_COUNT_REF(block) do { if (MP_STATE_MEM(gc_compact_refs) != NULL) { gc_compact_count_ref(block); } } while (0)
+#else
+#define GC_COMPACT_COUNT_REF(block)
+#endif
+
 #ifndef TRACE_MARK
 #if DEBUG_PRINT
 #define TRACE_MARK(block, ptr) DEBUG_printf("gc_mark(%p)\n", ptr)
@@ -222,6 +377,10 @@ STATIC void gc_mark_subtree(size_t block) {
     // Start with the block passed in the argument.
     size_t sp = 0;
     for (;;) {
+        #if MICROPY_GC_MARK_COUNT
+        MP_STATE_MEM(gc_mark_count)++;
+        #endif
+
         // work out number of consecutive blocks in the chain starting with this one
         size_t n_blocks = 0;
         do {
@@ -235,6 +394,7 @@ STATIC void gc_mark_subtree(size_t block) {
             if (VERIFY_PTR(ptr)) {
                 // Mark and push this pointer
                 size_t childblock = BLOCK_FROM_PTR(ptr);
+                GC_COMPACT_COUNT_REF(childblock);
                 if (ATB_GET_KIND(childblock) == AT_HEAD) {
                     // an unmarked head, mark it, and push it on gc stack
                     TRACE_MARK(childblock, ptr);
@@ -242,6 +402,15 @@ STATIC void gc_mark_subtree(size_t block) {
                     if (sp < MICROPY_ALLOC_GC_STACK_SIZE) {
                         MP_STATE_MEM(gc_stack)[sp++] = childblock;
                     } else {
+                        // flag the block to be traced later, and remember the
+                        // range of flagged blocks
+                        OTB_SET(childblock);
+                        if (!MP_STATE_MEM(gc_stack_overflow) || childblock < MP_STATE_MEM(gc_stack_overflow_first)) {
+                            MP_STATE_MEM(gc_stack_overflow_first) = childblock;
+                        }
+                        if (!MP_STATE_MEM(gc_stack_overflow) || childblock > MP_STATE_MEM(gc_stack_overflow_last)) {
+                            MP_STATE_MEM(gc_stack_overflow_last) = childblock;
+                        }
                         MP_STATE_MEM(gc_stack_overflow) = 1;
                     }
                 }
@@ -258,53 +427,103 @@ STATIC void gc_mark_subtree(size_t block) {
     }
 }
 
+// Trace the blocks that were marked but couldn't be pushed on the stack. Each
+// one is flagged in the OTB and its flag is cleared as it is traced, so no
+// block is traced twice however the overflows fall. Tracing a flagged block
+// can flag more: those ahead of the scan extend it, and those behind it move
+// the scan back to the lowest of them. Moving back only rereads the OTB, a
+// byte at a time where nothing is flagged.
 STATIC void gc_deal_with_stack_overflow(void) {
-    while (MP_STATE_MEM(gc_stack_overflow)) {
-        MP_STATE_MEM(gc_stack_overflow) = 0;
-
-        // scan entire memory looking for blocks which have been marked but not their children
-        for (size_t block = 0; block < MP_STATE_MEM(gc_alloc_table_byte_len) * BLOCKS_PER_ATB; block++) {
-            // trace (again) if mark bit set
-            if (ATB_GET_KIND(block) == AT_MARK) {
-                gc_mark_subtree(block);
+    if (!MP_STATE_MEM(gc_stack_overflow)) {
+        return;
+    }
+    MP_STATE_MEM(gc_stack_overflow) = 0;
+    size_t block = MP_STATE_MEM(gc_stack_overflow_first);
+    size_t end = MP_STATE_MEM(gc_stack_overflow_last);
+    while (block <= end) {
+        if (MP_STATE_MEM(gc_overflow_table_start)[block / BLOCKS_PER_OTB] == 0) {
+            block = (block | (BLOCKS_PER_OTB - 1)) + 1;
+            continue;
+        }
+        if (OTB_GET(block)) {
+            OTB_CLEAR(block);
+            gc_mark_subtree(block);
+            if (MP_STATE_MEM(gc_stack_overflow)) {
+                MP_STATE_MEM(gc_stack_overflow) = 0;
+                if (MP_STATE_MEM(gc_stack_overflow_last) > end) {
+                    end = MP_STATE_MEM(gc_stack_overflow_last);
+                }
+                if (MP_STATE_MEM(gc_stack_overflow_first) < block) {
+                    block = MP_STATE_MEM(gc_stack_overflow_first);
+                    continue;
+                }
             }
         }
+        block++;
     }
 }
 
-STATIC void gc_sweep(void) {
-    #if MICROPY_PY_GC_COLLECT_RETVAL
-    MP_STATE_MEM(gc_collected) = 0;
+#if MICROPY_ENABLE_FINALISER
+// Run the finaliser of the object at block, which is about to be freed.
+STATIC void gc_run_finaliser(size_t block) {
+    mp_obj_base_t *obj = (mp_obj_base_t*)PTR_FROM_BLOCK(block);
+    if (obj->type != NULL) {
+        // if the object has a type then see if it has a __del__ method
+        mp_obj_t dest[2];
+        mp_load_method_maybe(MP_OBJ_FROM_PTR(obj), MP_QSTR___del__, dest);
+        if (dest[0] != MP_OBJ_NULL) {
+            // load_method returned a method, execute it in a protected environment
+            #if MICROPY_ENABLE_SCHEDULER
+            mp_sched_lock();
+            #endif
+            mp_call_function_1_protected(dest[0], dest[1]);
+            #if MICROPY_ENABLE_SCHEDULER
+            mp_sched_unlock();
+            #endif
+        }
+    }
+    // clear finaliser flag
+    FTB_CLEAR(block);
+}
+#endif
+
+// Sweep blocks from start up to (but not including) end. Tail blocks at start
+// are kept, so a range must not start inside a chain whose head is unmarked.
+STATIC void gc_sweep_range(size_t start, size_t end) {
+    bool free_tail = false;
+    #if MICROPY_GC_INCREMENTAL_SWEEP
+    // Lowest and highest freed blocks, to let the allocator see them.
+    size_t first_freed = (size_t)-1;
+    size_t last_freed = 0;
+    #define NOTE_FREED(block) do { if (first_freed == (size_t)-1) { first_freed = (block); } last_freed = (block); } while (0)
+    #else
+    #define NOTE_FREED(block)
+    #endif
+    #if MICROPY_GC_FREE_LIST_CACHE
+    size_t free_run_start = 0;
+    size_t free_run_len = 0;
+    #define FREE_RUN_EXTEND(block) do { if (free_run_len++ == 0) { free_run_start = (block); } } while (0)
+    #define FREE_RUN_END() do { if (free_run_len > 0) { gc_free_list_add_run(free_run_start, free_run_len); free_run_len = 0; } } while (0)
+    #else
+    #define FREE_RUN_EXTEND(block)
+    #define FREE_RUN_END()
     #endif
     // free unmarked heads and their tails
-    int free_tail = 0;
-    for (size_t block = 0; block < MP_STATE_MEM(gc_alloc_table_byte_len) * BLOCKS_PER_ATB; block++) {
+    for (size_t block = start; block < end; block++) {
         switch (ATB_GET_KIND(block)) {
+            case AT_FREE:
+                FREE_RUN_EXTEND(block);
+                break;
+
             case AT_HEAD:
 #if MICROPY_ENABLE_FINALISER
                 if (FTB_GET(block)) {
-                    mp_obj_base_t *obj = (mp_obj_base_t*)PTR_FROM_BLOCK(block);
-                    if (obj->type != NULL) {
-                        // if the object has a type then see if it has a __del__ method
-                        mp_obj_t dest[2];
-                        mp_load_method_maybe(MP_OBJ_FROM_PTR(obj), MP_QSTR___del__, dest);
-                        if (dest[0] != MP_OBJ_NULL) {
-                            // load_method returned a method, execute it in a protected environment
-                            #if MICROPY_ENABLE_SCHEDULER
-                            mp_sched_lock();
-                            #endif
-                            mp_call_function_1_protected(dest[0], dest[1]);
-                            #if MICROPY_ENABLE_SCHEDULER
-                            mp_sched_unlock();
-                            #endif
-                        }
-                    }
-                    // clear finaliser flag
-                    FTB_CLEAR(block);
+                    gc_run_finaliser(block);
                 }
 #endif
-                free_tail = 1;
+                free_tail = true;
                 ATB_ANY_TO_FREE(block);
+                NOTE_FREED(block);
                 #if CLEAR_ON_SWEEP
                 memset((void*)PTR_FROM_BLOCK(block), 0, BYTES_PER_BLOCK);
                 #endif
@@ -316,29 +535,133 @@ STATIC void gc_sweep(void) {
                 #if MICROPY_PY_GC_COLLECT_RETVAL
                 MP_STATE_MEM(gc_collected)++;
                 #endif
+                FREE_RUN_EXTEND(block);
                 break;
 
             case AT_TAIL:
                 if (free_tail) {
                     ATB_ANY_TO_FREE(block);
+                    NOTE_FREED(block);
                     #if CLEAR_ON_SWEEP
                     memset((void*)PTR_FROM_BLOCK(block), 0, BYTES_PER_BLOCK);
                     #endif
+                    FREE_RUN_EXTEND(block);
+                } else {
+                    FREE_RUN_END();
                 }
                 break;
 
             case AT_MARK:
                 ATB_MARK_TO_HEAD(block);
-                free_tail = 0;
+                free_tail = false;
+                FREE_RUN_END();
                 break;
         }
     }
+    FREE_RUN_END();
+    #undef FREE_RUN_EXTEND
+    #undef FREE_RUN_END
+
+    #if MICROPY_GC_INCREMENTAL_SWEEP
+    if (first_freed != (size_t)-1) {
+        if (first_freed / BLOCKS_PER_ATB < MP_STATE_MEM(gc_first_free_atb_index)) {
+            MP_STATE_MEM(gc_first_free_atb_index) = first_freed / BLOCKS_PER_ATB;
+        }
+        if (last_freed / BLOCKS_PER_ATB > MP_STATE_MEM(gc_last_free_atb_index)) {
+            MP_STATE_MEM(gc_last_free_atb_index) = last_freed / BLOCKS_PER_ATB;
+        }
+    }
+    #endif
+    #undef NOTE_FREED
+}
+
+STATIC void gc_sweep(void) {
+    #if MICROPY_PY_GC_COLLECT_RETVAL
+    MP_STATE_MEM(gc_collected) = 0;
+    #endif
+    #if MICROPY_GC_FREE_LIST_CACHE
+    gc_free_list_reset();
+    #endif
+    gc_sweep_range(0, MP_STATE_MEM(gc_alloc_table_byte_len) * BLOCKS_PER_ATB);
+}
+
+#if MICROPY_GC_INCREMENTAL_SWEEP
+#define GC_SWEEP_PENDING() (MP_STATE_MEM(gc_sweep_block) < MP_STATE_MEM(gc_alloc_table_byte_len) * BLOCKS_PER_ATB)
+
+// Start a sweep that is done in steps by gc_sweep_continue. Until it is
+// finished, live blocks beyond gc_sweep_block are still marked. The steps can
+// be taken from background tasks, outside of any bytecode, so the finalisers
+// of everything that is going to be freed are run now, by the collection.
+STATIC void gc_sweep_begin(void) {
+    #if MICROPY_PY_GC_COLLECT_RETVAL
+    MP_STATE_MEM(gc_collected) = 0;
+    #endif
+    #if MICROPY_GC_FREE_LIST_CACHE
+    gc_free_list_reset();
+    #endif
+    #if MICROPY_ENABLE_FINALISER
+    // Skip a byte of the FTB at a time where no block has a finaliser.
+    byte *ftb = MP_STATE_MEM(gc_finaliser_table_start);
+    for (size_t block = 0; block < MP_STATE_MEM(gc_alloc_table_byte_len) * BLOCKS_PER_ATB; block++) {
+        if (ftb[block / BLOCKS_PER_FTB] == 0) {
+            block |= BLOCKS_PER_FTB - 1;
+        } else if (FTB_GET(block) && ATB_GET_KIND(block) == AT_HEAD) {
+            gc_run_finaliser(block);
+        }
+    }
+    #endif
+    MP_STATE_MEM(gc_sweep_block) = 0;
+}
+
+// Sweep about n_blocks more of a pending sweep. A step always finishes the
+// chain it is in, so that no tail of a freed head is left past gc_sweep_block
+// for gc_nbytes or an in place realloc to take as part of a new allocation.
+// It only updates the ATB: gc_sweep_begin has already run the finalisers. The
+// GC must be entered, and it is locked while sweeping.
+STATIC void gc_sweep_continue(size_t n_blocks) {
+    size_t start = MP_STATE_MEM(gc_sweep_block);
+    size_t total = MP_STATE_MEM(gc_alloc_table_byte_len) * BLOCKS_PER_ATB;
+    size_t end = total - start > n_blocks ? start + n_blocks : total;
+    while (end < total && ATB_GET_KIND(end) == AT_TAIL) {
+        end++;
+    }
+    MP_STATE_MEM(gc_lock_depth)++;
+    gc_sweep_range(start, end);
+    MP_STATE_MEM(gc_sweep_block) = end;
+    MP_STATE_MEM(gc_lock_depth)--;
+}
+
+// Finish a pending sweep, unless the GC is locked (which includes being
+// called from a finaliser run by the collection).
+STATIC void gc_sweep_finish(void) {
+    if (GC_SWEEP_PENDING() && MP_STATE_MEM(gc_lock_depth) == 0) {
+        gc_sweep_continue(MP_STATE_MEM(gc_alloc_table_byte_len) * BLOCKS_PER_ATB);
+    }
+}
+
+// Blocks allocated while a sweep is pending must survive it. Chains starting
+// in the unswept part are allocated marked. A chain that the sweep will resume
+// inside keeps its tail, since a step starts with tails kept.
+STATIC void gc_sweep_note_alloc(size_t start_block) {
+    if (start_block >= MP_STATE_MEM(gc_sweep_block)) {
+        ATB_HEAD_TO_MARK(start_block);
+    }
+}
+
+void gc_sweep_step(void) {
+    GC_ENTER();
+    if (MP_STATE_MEM(gc_lock_depth) == 0 && GC_SWEEP_PENDING()) {
+        gc_sweep_continue(MICROPY_GC_SWEEP_STEP_BLOCKS);
+    }
+    GC_EXIT();
 }
+#endif
 
 // Mark can handle NULL pointers because it verifies the pointer is within the heap bounds.
 STATIC void gc_mark(void* ptr) {
     if (VERIFY_PTR(ptr)) {
         size_t block = BLOCK_FROM_PTR(ptr);
+        GC_COMPACT_COUNT_REF(block);
         if (ATB_GET_KIND(block) == AT_HEAD) {
             // An unmarked head: mark it, and mark all its children
             TRACE_MARK(block, ptr);
@@ -350,11 +673,25 @@ STATIC void gc_mark(void* ptr) {
 
 void gc_collect_start(void) {
     GC_ENTER();
+    #if MICROPY_GC_INCREMENTAL_SWEEP
+    // The previous sweep must be done before anything is marked again.
+    gc_sweep_finish();
+    #endif
     MP_STATE_MEM(gc_lock_depth)++;
     #if MICROPY_GC_ALLOC_THRESHOLD
     MP_STATE_MEM(gc_alloc_amount) = 0;
     #endif
     MP_STATE_MEM(gc_stack_overflow) = 0;
+    #if MICROPY_GC_MARK_COUNT
+    MP_STATE_MEM(gc_mark_count) = 0;
+    #endif
+
+    #if MICROPY_GC_COMPACT
+    if (MP_STATE_MEM(gc_compact_refs) != NULL) {
+        // Keep the reference counts, without tracing them.
+        ATB_HEAD_TO_MARK(BLOCK_FROM_PTR(MP_STATE_MEM(gc_compact_refs)));
+    }
+    #endif
 
     // Trace root pointers.  This relies on the root pointers being organised
     // correctly in the mp_state_ctx structure.  We scan nlr_top, dict_locals,
@@ -384,9 +721,133 @@ void gc_collect_root(void **ptrs, size_t len) {
     }
 }
 
+#if MICROPY_GC_COMPACT
+// Return where an object keeps the pointer to its movable storage, if it is a
+// bytearray, array or list.
+STATIC void **gc_compact_storage_ptr(size_t block) {
+    mp_obj_base_t *o = (mp_obj_base_t*)PTR_FROM_BLOCK(block);
+    #if MICROPY_PY_BUILTINS_BYTEARRAY || MICROPY_PY_ARRAY
+    #if MICROPY_PY_BUILTINS_BYTEARRAY
+    if (o->type == &mp_type_bytearray) {
+        return &((mp_obj_array_t*)o)->items;
+    }
+    #endif
+    #if MICROPY_PY_ARRAY
+    if (o->type == &mp_type_array) {
+        return &((mp_obj_array_t*)o)->items;
+    }
+    #endif
+    #endif
+    if (o->type == &mp_type_list) {
+        return (void**)&((mp_obj_list_t*)o)->items;
+    }
+    return NULL;
+}
+
+// Move storage that is only referenced by its owner down into the lowest free
+// run below it, so that free space collects at the top of the short lived
+// region. The heap has just been swept, so nothing is marked. Storage with
+// any other reference, including one from the stack or an aligned pointer
+// into its tail, stays put.
+STATIC void gc_compact_relocate(void) {
+    size_t end = BLOCK_FROM_PTR(MP_STATE_MEM(gc_lowest_long_lived_ptr));
+    size_t first_free = 0;
+    for (size_t block = 0; block < end; block++) {
+        if (ATB_GET_KIND(block) != AT_HEAD) {
+            continue;
+        }
+        void **storage = gc_compact_storage_ptr(block);
+        if (storage == NULL || !VERIFY_PTR(*storage)) {
+            continue;
+        }
+        size_t src = BLOCK_FROM_PTR(*storage);
+        if (src >= end || ATB_GET_KIND(src) != AT_HEAD || GC_COMPACT_REFS(src) != 1
+            #if MICROPY_ENABLE_FINALISER
+            || FTB_GET(src)
+            #endif
+            ) {
+            continue;
+        }
+        size_t n_blocks = 1;
+        bool pinned = false;
+        while (src + n_blocks < end && ATB_GET_KIND(src + n_blocks) == AT_TAIL) {
+            pinned |= GC_COMPACT_REFS(src + n_blocks) != 0;
+            n_blocks++;
+        }
+        if (pinned) {
+            continue;
+        }
+
+        // find the lowest free run that fits, below the storage
+        while (first_free < src && ATB_GET_KIND(first_free) != AT_FREE) {
+            first_free++;
+        }
+        size_t dest = first_free;
+        size_t n_free = 0;
+        for (size_t b = first_free; b < src && n_free < n_blocks; b++) {
+            if (ATB_GET_KIND(b) == AT_FREE) {
+                n_free++;
+            } else {
+                dest = b + 1;
+                n_free = 0;
+            }
+        }
+        if (n_free < n_blocks || dest + n_blocks > src) {
+            continue;
+        }
+
+        ATB_FREE_TO_HEAD(dest);
+        for (size_t i = 1; i < n_blocks; i++) {
+            ATB_FREE_TO_TAIL(dest + i);
+        }
+        memcpy((void*)PTR_FROM_BLOCK(dest), *storage, n_blocks * BYTES_PER_BLOCK);
+        for (size_t i = 0; i < n_blocks; i++) {
+            ATB_ANY_TO_FREE(src + i);
+        }
+        *storage = (void*)PTR_FROM_BLOCK(dest);
+        // the counts are for the old position, so don't move it again
+        GC_COMPACT_PIN(dest);
+        #ifdef LOG_HEAP_ACTIVITY
+        gc_log_change(src, 0);
+        gc_log_change(dest, n_blocks);
+        #endif
+    }
+    #if MICROPY_GC_FREE_LIST_CACHE
+    gc_free_list_reset();
+    #endif
+}
+
+void gc_compact(void) {
+    size_t len = MP_STATE_MEM(gc_alloc_table_byte_len);
+    byte *refs = gc_alloc(len, false, false);
+    if (refs == NULL) {
+        return;
+    }
+    memset(refs, 0, len);
+    MP_STATE_MEM(gc_compact_refs) = refs;
+    gc_collect();
+    MP_STATE_MEM(gc_compact_refs) = NULL;
+    gc_free(refs);
+}
+#endif
+
 void gc_collect_end(void) {
     gc_deal_with_stack_overflow();
-    gc_sweep();
+    #if MICROPY_GC_INCREMENTAL_SWEEP
+    if (MP_STATE_MEM(gc_sweep_defer)) {
+        MP_STATE_MEM(gc_sweep_defer) = false;
+        gc_sweep_begin();
+    } else
+    #endif
+    {
+        gc_sweep();
+    }
+    #if MICROPY_GC_COMPACT
+    if (MP_STATE_MEM(gc_compact_refs) != NULL) {
+        gc_compact_relocate();
+        MP_STATE_MEM(gc_compact_refs) = NULL;
+    }
+    #endif
     MP_STATE_MEM(gc_first_free_atb_index) = 0;
     MP_STATE_MEM(gc_last_free_atb_index) = MP_STATE_MEM(gc_alloc_table_byte_len) - 1;
     MP_STATE_MEM(gc_lock_depth)--;
@@ -395,6 +856,11 @@ void gc_collect_end(void) {
 
 void gc_sweep_all(void) {
     GC_ENTER();
+    #if MICROPY_GC_INCREMENTAL_SWEEP
+    // Unmark whatever a pending sweep hasn't reached yet so it is freed below.
+    gc_sweep_finish();
+    MP_STATE_MEM(gc_sweep_defer) = false;
+    #endif
     MP_STATE_MEM(gc_lock_depth)++;
     MP_STATE_MEM(gc_stack_overflow) = 0;
     gc_collect_end();
@@ -402,6 +868,9 @@ void gc_sweep_all(void) {
 
 void gc_info(gc_info_t *info) {
     GC_ENTER();
+    #if MICROPY_GC_INCREMENTAL_SWEEP
+    gc_sweep_finish();
+    #endif
     info->total = MP_STATE_MEM(gc_pool_end) - MP_STATE_MEM(gc_pool_start);
     info->used = 0;
     info->free = 0;
@@ -496,6 +965,9 @@ void *gc_alloc(size_t n_bytes, bool has_finaliser, bool long_lived) {
     #if MICROPY_GC_ALLOC_THRESHOLD
     if (!collected && MP_STATE_MEM(gc_alloc_amount) >= MP_STATE_MEM(gc_alloc_threshold)) {
         GC_EXIT();
+        #if MICROPY_GC_INCREMENTAL_SWEEP
+        MP_STATE_MEM(gc_sweep_defer) = true;
+        #endif
         gc_collect();
         collected = 1;
         GC_ENTER();
@@ -504,6 +976,20 @@ void *gc_alloc(size_t n_bytes, bool has_finaliser, bool long_lived) {
 
     bool keep_looking = true;
 
+    #if MICROPY_GC_FREE_LIST_CACHE
+    // Small short lived allocations are served from the runs cached by the last sweep.
+    bool from_free_list = false;
+    if (!long_lived && n_blocks <= MICROPY_GC_FREE_LIST_CLASSES) {
+        size_t block = gc_free_list_pop(n_blocks);
+        if (block != (size_t)-1) {
+            found_block = block + n_blocks - 1;
+            n_free = n_blocks;
+            from_free_list = true;
+            keep_looking = false;
+        }
+    }
+    #endif
+
     // When we start searching on the other side of the crossover block we make sure to
     // perform a collect. That way we'll get the closest free block in our section.
     size_t crossover_block = BLOCK_FROM_PTR(MP_STATE_MEM(gc_lowest_long_lived_ptr));
@@ -515,9 +1001,96 @@ void *gc_alloc(size_t n_bytes, bool has_finaliser, bool long_lived) {
             start = MP_STATE_MEM(gc_last_free_atb_index);
         }
         n_free = 0;
+        byte *atb = MP_STATE_MEM(gc_alloc_table_start);
         // look for a run of n_blocks available blocks
         for (size_t i = start; keep_looking && MP_STATE_MEM(gc_first_free_atb_index) <= i && i <= MP_STATE_MEM(gc_last_free_atb_index); i += direction) {
-            byte a = MP_STATE_MEM(gc_alloc_table_start)[i];
+            #if MICROPY_GC_INCREMENTAL_SWEEP
+            // Sweep lazily, just ahead of a forward search, so the search never needs to
+            // go back over what it has already looked at.
+            while (direction == 1 && (i + BYTES_PER_WORD) * BLOCKS_PER_ATB > MP_STATE_MEM(gc_sweep_block) && GC_SWEEP_PENDING()) {
+                gc_sweep_continue(MICROPY_GC_SWEEP_STEP_BLOCKS);
+            }
+            #endif
+            // If a whole aligned word of the ATB is entirely free or entirely used then handle it
+            // in one step. i is left on the last byte of the word in the search direction.
+            size_t word_start = direction == 1 ? i : i + 1 - BYTES_PER_WORD;
+            if ((direction == 1 || i + 1 >= BYTES_PER_WORD) &&
+                ((uintptr_t)(atb + word_start) & (BYTES_PER_WORD - 1)) == 0 &&
+                word_start >= MP_STATE_MEM(gc_first_free_atb_index) &&
+                word_start + BYTES_PER_WORD - 1 <= MP_STATE_MEM(gc_last_free_atb_index)) {
+                mp_uint_t w = *(mp_uint_t*)(void*)(atb + word_start);
+                size_t first_block = word_start * BLOCKS_PER_ATB;
+                if (w == 0) {
+                    if (n_blocks - n_free <= BLOCKS_PER_WORD) {
+                        if (direction == 1) {
+                            found_block = first_block + (n_blocks - n_free) - 1;
+                        } else {
+                            found_block = first_block + BLOCKS_PER_WORD - (n_blocks - n_free);
+                        }
+                        n_free = n_blocks;
+                        keep_looking = false;
+                    } else {
+                        n_free += BLOCKS_PER_WORD;
+                    }
+                    i = direction == 1 ? word_start + BYTES_PER_WORD - 1 : word_start;
+                    continue;
+                }
+                if (ATB_FREE_PAIRS(w, ATB_PAIRS_LOW_WORD) == 0) {
+                    n_free = 0;
+                    if (!collected &&
+                            ((direction == 1 && first_block + BLOCKS_PER_WORD - 1 >= crossover_block) ||
+                            (direction == -1 && first_block < crossover_block))) {
+                        keep_looking = false;
+                    }
+                    i = direction == 1 ? word_start + BYTES_PER_WORD - 1 : word_start;
+                    continue;
+                }
+            }
+
+            byte a = atb[i];
+            unsigned int free_pairs = ATB_FREE_PAIRS(a, ATB_PAIRS_LOW_BYTE);
+            // A run of n_blocks > 2 can't fit between two used blocks in the same byte, so only
+            // the free blocks at either end of the byte matter. Count them with ctz/clz.
+            if (free_pairs == 0 || n_blocks > 2) {
+                unsigned int used_pairs = ~free_pairs & ATB_PAIRS_LOW_BYTE;
+                size_t low_free = BLOCKS_PER_ATB;
+                size_t high_free = BLOCKS_PER_ATB;
+                if (used_pairs != 0) {
+                    low_free = __builtin_ctz(used_pairs) / 2;
+                    high_free = BLOCKS_PER_ATB - 1 - (31 - __builtin_clz(used_pairs)) / 2;
+                }
+                size_t continued = direction == 1 ? low_free : high_free;
+                if (n_free + continued >= n_blocks) {
+                    if (direction == 1) {
+                        found_block = i * BLOCKS_PER_ATB + (n_blocks - n_free) - 1;
+                    } else {
+                        found_block = i * BLOCKS_PER_ATB + BLOCKS_PER_ATB - (n_blocks - n_free);
+                    }
+                    n_free = n_blocks;
+                    keep_looking = false;
+                } else if (used_pairs == 0) {
+                    n_free += BLOCKS_PER_ATB;
+                } else {
+                    n_free = direction == 1 ? high_free : low_free;
+                    if (!collected &&
+                            ((direction == 1 && i * BLOCKS_PER_ATB + BLOCKS_PER_ATB - 1 - high_free >= crossover_block) ||
+                            (direction == -1 && i * BLOCKS_PER_ATB + low_free < crossover_block))) {
+                        n_free = 0;
+                        keep_looking = false;
+                    } else if (n_free >= n_blocks) {
+                        // the free blocks at the far end of this byte are enough on their own
+                        if (direction == 1) {
+                            found_block = i * BLOCKS_PER_ATB + BLOCKS_PER_ATB - high_free + n_blocks - 1;
+                        } else {
+                            found_block = i * BLOCKS_PER_ATB + low_free - n_blocks;
+                        }
+                        n_free = n_blocks;
+                        keep_looking = false;
+                    }
+                }
+                continue;
+            }
+
             // Four ATB states are packed into a single byte.
             int j = 0;
             if (direction == -1) {
@@ -545,12 +1118,26 @@ void *gc_alloc(size_t n_bytes, bool has_finaliser, bool long_lived) {
             break;
         }
 
+        #if MICROPY_GC_INCREMENTAL_SWEEP
+        // A forward search has swept everything it looked at, so what is left is either
+        // beyond the crossover block or at the top of the heap where a backward search
+        // starts. Finish the sweep and look again before collecting.
+        if (GC_SWEEP_PENDING()) {
+            gc_sweep_finish();
+            keep_looking = true;
+            continue;
+        }
+        #endif
+
         GC_EXIT();
         // nothing found!
         if (collected) {
             return NULL;
         }
         DEBUG_printf("gc_alloc(" UINT_FMT "): no free mem, triggering GC\n", n_bytes);
+        #if MICROPY_GC_INCREMENTAL_SWEEP
+        MP_STATE_MEM(gc_sweep_defer) = true;
+        #endif
         gc_collect();
         collected = true;
         // Try again since we've hopefully freed up space.
@@ -564,10 +1151,21 @@ void *gc_alloc(size_t n_bytes, bool has_finaliser, bool long_lived) {
     // next scan.  To reduce fragmentation, we only do this if we were looking
     // for a single free block, which guarantees that there are no free blocks
     // before this one.  Also, whenever we free or shrink a block we must check
-    // if this index needs adjusting (see gc_realloc and gc_free).
+    // if this index needs adjusting (see gc_realloc and gc_free).  Blocks from
+    // the free list cache may have free blocks before them so leave it alone.
     if (!long_lived) {
         end_block = found_block;
         start_block = found_block - n_free + 1;
+        #if MICROPY_GC_FREE_LIST_CACHE
+        if (from_free_list) {
+            // Only skip ATBs which are now completely used.
+            size_t i = MP_STATE_MEM(gc_first_free_atb_index);
+            while (i <= end_block / BLOCKS_PER_ATB && ATB_FREE_PAIRS(MP_STATE_MEM(gc_alloc_table_start)[i], ATB_PAIRS_LOW_BYTE) == 0) {
+                i++;
+            }
+            MP_STATE_MEM(gc_first_free_atb_index) = i;
+        } else
+        #endif
         if (n_blocks == 1) {
             MP_STATE_MEM(gc_first_free_atb_index) = (found_block + 1) / BLOCKS_PER_ATB;
         }
@@ -592,6 +1190,10 @@ void *gc_alloc(size_t n_bytes, bool has_finaliser, bool long_lived) {
         ATB_FREE_TO_TAIL(bl);
     }
 
+    #if MICROPY_GC_INCREMENTAL_SWEEP
+    gc_sweep_note_alloc(start_block);
+    #endif
+
     // get pointer to first block
     // we must create this pointer before unlocking the GC so a collection can find it
     void *ret_ptr = (void*)(MP_STATE_MEM(gc_pool_start) + start_block * BYTES_PER_BLOCK);
@@ -639,6 +1241,10 @@ void *gc_alloc(size_t n_bytes, bool has_finaliser, bool long_lived) {
     gc_dump_alloc_table();
     #endif
 
+    #if MICROPY_GC_ALLOC_PROFILE
+    gc_alloc_profile_record(n_bytes);
+    #endif
+
     return ret_ptr;
 }
 
@@ -673,7 +1279,7 @@ void gc_free(void *ptr) {
         // get the GC block number corresponding to this pointer
         assert(VERIFY_PTR(ptr));
         size_t block = BLOCK_FROM_PTR(ptr);
-        assert(ATB_GET_KIND(block) == AT_HEAD);
+        assert(ATB_IS_HEAD(block));
 
         #if MICROPY_ENABLE_FINALISER
         FTB_CLEAR(block);
@@ -708,7 +1314,7 @@ size_t gc_nbytes(const void *ptr) {
     GC_ENTER();
     if (VERIFY_PTR(ptr)) {
         size_t block = BLOCK_FROM_PTR(ptr);
-        if (ATB_GET_KIND(block) == AT_HEAD) {
+        if (ATB_IS_HEAD(block)) {
             // work out number of consecutive blocks in the chain starting with this on
             size_t n_blocks = 0;
             do {
@@ -821,7 +1427,7 @@ void *gc_realloc(void *ptr_in, size_t n_bytes, bool allow_move) {
     // get the GC block number corresponding to this pointer
     assert(VERIFY_PTR(ptr));
     size_t block = BLOCK_FROM_PTR(ptr);
-    assert(ATB_GET_KIND(block) == AT_HEAD);
+    assert(ATB_IS_HEAD(block));
 
     // compute number of new blocks that are requested
     size_t new_blocks = (n_bytes + BYTES_PER_BLOCK - 1) / BYTES_PER_BLOCK;
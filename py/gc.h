@@ -63,6 +63,27 @@ void *gc_alloc(size_t n_bytes, bool has_finaliser, bool long_lived);
 // Use this function to sweep the whole heap and run all finalisers
 void gc_sweep_all(void);
 
+#if MICROPY_GC_INCREMENTAL_SWEEP
+// Sweep the next MICROPY_GC_SWEEP_STEP_BLOCKS blocks of a pending sweep, if any.
+// Ports call this regularly, for example from their background tasks. It never
+// runs finalisers: the collection has already run them.
+void gc_sweep_step(void);
+#endif
+
+#if MICROPY_GC_COMPACT
+// Do a full collection and move the storage of bytearrays, arrays and lists
+// down the heap to merge free blocks. Only call this when no C code holds a
+// pointer into such storage that the GC can't see, like a DMA transfer.
+void gc_compact(void);
+#endif
+
+#if MICROPY_GC_ALLOC_PROFILE
+// Called after each successful allocation, outside the GC lock. It must not
+// allocate from the GC heap. MP_STATE_THREAD(current_code_state) gives the
+// running bytecode, and its caller field the frames below it.
+void gc_alloc_profile_record(size_t n_bytes);
+#endif
+
 void gc_free(void *ptr); // does not call finaliser
 size_t gc_nbytes(const void *ptr);
 bool gc_has_finaliser(const void *ptr);
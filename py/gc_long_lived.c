@@ -55,10 +55,10 @@ mp_obj_fun_bc_t *make_fun_bc_long_lived(mp_obj_fun_bc_t *fun_bc, uint8_t max_dep
     }
     fun_bc->const_table = gc_make_long_lived((mp_uint_t*) fun_bc->const_table);
     // extra_args stores keyword only argument default values.
-    size_t words = gc_nbytes(fun_bc) / sizeof(mp_uint_t*);
-    // Functions (mp_obj_fun_bc_t) have four pointers (base, globals, bytecode and const_table)
-    // before the variable length extra_args so remove them from the length.
-    for (size_t i = 0; i < words - 4; i++) {
+    // Functions (mp_obj_fun_bc_t) have a fixed header (base, globals, bytecode, const_table
+    // and maybe qstr_table) before the variable length extra_args so remove it from the length.
+    size_t words = (gc_nbytes(fun_bc) - offsetof(mp_obj_fun_bc_t, extra_args)) / sizeof(mp_obj_t);
+    for (size_t i = 0; i < words; i++) {
         if (fun_bc->extra_args[i] == NULL) {
             continue;
         }
@@ -102,6 +102,12 @@ mp_obj_dict_t *make_dict_long_lived(mp_obj_dict_t *dict, uint8_t max_depth) {
     // Update all of the references first so that we reduce the chance of references to the old
     // copies.
     dict->map.table = gc_make_long_lived(dict->map.table);
+    #if MICROPY_OPT_LOAD_GLOBAL_CACHE
+    if (dict->map.is_watched) {
+        // the load global cache may point into the old table
+        MP_STATE_VM(load_global_cache_version) += 1;
+    }
+    #endif
     for (size_t i = 0; i < dict->map.alloc; i++) {
         if (MP_MAP_SLOT_IS_FILLED(&dict->map, i)) {
             mp_obj_t value = dict->map.table[i].value;
@@ -114,6 +120,21 @@ mp_obj_dict_t *make_dict_long_lived(mp_obj_dict_t *dict, uint8_t max_depth) {
     return dict;
 }
 
+mp_obj_list_t *make_list_long_lived(mp_obj_list_t *list, uint8_t max_depth) {
+    #ifndef MICROPY_ENABLE_GC
+    return list;
+    #endif
+    if (max_depth == 0) {
+        return list;
+    }
+    // Move the items too, otherwise they pin their old spot in the short lived portion.
+    list->items = gc_make_long_lived(list->items);
+    for (size_t i = 0; i < list->len; i++) {
+        list->items[i] = make_obj_long_lived(list->items[i], max_depth - 1);
+    }
+    return gc_make_long_lived(list);
+}
+
 mp_obj_str_t *make_str_long_lived(mp_obj_str_t *str) {
     str->data = gc_make_long_lived((byte *) str->data);
     return gc_make_long_lived(str);
@@ -137,6 +158,9 @@ mp_obj_t make_obj_long_lived(mp_obj_t obj, uint8_t max_depth){
     } else if (MP_OBJ_IS_TYPE(obj, &mp_type_property)) {
         mp_obj_property_t *prop = MP_OBJ_TO_PTR(obj);
         return MP_OBJ_FROM_PTR(make_property_long_lived(prop, max_depth));
+    } else if (MP_OBJ_IS_TYPE(obj, &mp_type_list)) {
+        mp_obj_list_t *list = MP_OBJ_TO_PTR(obj);
+        return MP_OBJ_FROM_PTR(make_list_long_lived(list, max_depth));
     } else if (MP_OBJ_IS_TYPE(obj, &mp_type_str) || MP_OBJ_IS_TYPE(obj, &mp_type_bytes)) {
         mp_obj_str_t *str = MP_OBJ_TO_PTR(obj);
         return MP_OBJ_FROM_PTR(make_str_long_lived(str));
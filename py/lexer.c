@@ -121,6 +121,29 @@ STATIC bool is_tail_of_identifier(mp_lexer_t *lex) {
     return is_head_of_identifier(lex) || is_digit(lex);
 }
 
+// Read the rest of the next block from the source, if the reader can do so, and
+// return its first byte; otherwise read a single byte.
+STATIC unichar read_block(mp_lexer_t *lex) {
+    if (lex->reader.readbuf == NULL) {
+        return lex->reader.readbyte(lex->reader.data);
+    }
+    size_t len;
+    const byte *buf = lex->reader.readbuf(lex->reader.data, &len);
+    if (buf == NULL) {
+        return MP_LEXER_EOF;
+    }
+    lex->buf_cur = buf + 1;
+    lex->buf_end = buf + len;
+    return *buf;
+}
+
+static inline unichar read_char(mp_lexer_t *lex) {
+    if (lex->buf_cur < lex->buf_end) {
+        return *lex->buf_cur++;
+    }
+    return read_block(lex);
+}
+
 STATIC void next_char(mp_lexer_t *lex) {
     if (lex->chr0 == '\n') {
         // a new line
@@ -136,14 +159,14 @@ STATIC void next_char(mp_lexer_t *lex) {
 
     lex->chr0 = lex->chr1;
     lex->chr1 = lex->chr2;
-    lex->chr2 = lex->reader.readbyte(lex->reader.data);
+    lex->chr2 = read_char(lex);
 
     if (lex->chr1 == '\r') {
         // CR is a new line, converted to LF
         lex->chr1 = '\n';
         if (lex->chr2 == '\n') {
             // CR LF is a single new line, throw out the extra LF
-            lex->chr2 = lex->reader.readbyte(lex->reader.data);
+            lex->chr2 = read_char(lex);
         }
     }
 
@@ -674,6 +697,7 @@ mp_lexer_t *mp_lexer_new(qstr src_name, mp_reader_t reader) {
 
     lex->source_name = src_name;
     lex->reader = reader;
+    lex->buf_cur = lex->buf_end = NULL;
     lex->line = 1;
     lex->column = (size_t)-2; // account for 3 dummy bytes
     lex->emit_dent = 0;
@@ -148,6 +148,8 @@ typedef enum _mp_token_kind_t {
 typedef struct _mp_lexer_t {
     qstr source_name;           // name of source
     mp_reader_t reader;         // stream source
+    const byte *buf_cur;        // next byte in the block last read from source
+    const byte *buf_end;        // end of that block
 
     unichar chr0, chr1, chr2;   // current cached characters from source
 
@@ -320,6 +320,38 @@ def make_bytes(cfg_bytes_len, cfg_bytes_hash, qstr):
     qhash_str = ('\\x%02x' * cfg_bytes_hash) % tuple(((qhash >> (8 * i)) & 0xff) for i in range(cfg_bytes_hash))
     return '(const byte*)"%s%s" "%s"' % (qhash_str, qlen_str, qdata)
 
+# this must match qstr_index_hash in qstr.c
+def compute_index_hash(qbytes, cfg_bytes_hash):
+    return compute_hash(qbytes, cfg_bytes_hash) ^ (len(qbytes) << (8 * cfg_bytes_hash))
+
+def print_qstr_hash_index(cfg_bytes_len, cfg_bytes_hash, qstrs):
+    # Index the qstrs by hash so the ROM pool can be searched without a scan.
+    # The hashes are only 1 or 2 bytes so they are not unique, and there is no
+    # perfect hash over them; instead the qstrs are grouped into buckets of a
+    # few entries each.  QHASH_BUCKET gives the offset of the first entry of
+    # each bucket and a final end offset, QHASH_ENTRY the qstrs in bucket order.
+    entries = sorted(qstrs.values(), key=lambda x: x[0])
+    if len(entries) >= 0x10000:
+        print('too many qstrs for the hash index')
+        assert False
+    num_buckets = 1
+    while num_buckets * 4 < len(entries):
+        num_buckets *= 2
+    buckets = [[] for _ in range(num_buckets)]
+    for order, ident, qstr in entries:
+        index_hash = compute_index_hash(bytes_cons(qstr, 'utf8'), cfg_bytes_hash)
+        buckets[index_hash & (num_buckets - 1)].append(ident)
+    print()
+    start = 0
+    for bucket in buckets:
+        print('QHASH_BUCKET(%u)' % start)
+        start += len(bucket)
+    print('QHASH_BUCKET(%u)' % start)
+    for bucket in buckets:
+        for ident in bucket:
+            print('QHASH_ENTRY(MP_QSTR_%s)' % ident)
+    print()
+
 def print_qstr_data(encoding_table, qcfgs, qstrs, i18ns):
     # get config variables
     cfg_bytes_len = int(qcfgs['BYTES_IN_LEN'])
@@ -340,6 +372,8 @@ def print_qstr_data(encoding_table, qcfgs, qstrs, i18ns):
         print('QDEF(MP_QSTR_%s, %s)' % (ident, qbytes))
         total_qstr_size += len(qstr)
 
+    print_qstr_hash_index(cfg_bytes_len, cfg_bytes_hash, qstrs)
+
     total_text_size = 0
     total_text_compressed_size = 0
     for original, translation in i18ns:
@@ -199,6 +199,56 @@ void m_free(void *ptr) {
     #endif
 }
 
+typedef struct _m_arena_chunk_t {
+    struct _m_arena_chunk_t *next;
+    size_t alloc;
+    size_t used;
+    mp_uint_t data[];
+} m_arena_chunk_t;
+
+void *m_arena_alloc(m_arena_t *arena, size_t num_bytes) {
+    // keep everything word aligned
+    num_bytes = (num_bytes + sizeof(mp_uint_t) - 1) & ~(sizeof(mp_uint_t) - 1);
+
+    m_arena_chunk_t *chunk = arena->chunk;
+    if (chunk != NULL && chunk->used + num_bytes > chunk->alloc) {
+        // not enough room at end of the current chunk so try to grow it in place
+        if (m_renew_maybe(byte, chunk, sizeof(m_arena_chunk_t) + chunk->alloc,
+            sizeof(m_arena_chunk_t) + chunk->used + num_bytes, false) == NULL) {
+            // could not grow it; shrink it to fit and start a new chunk
+            (void)m_renew_maybe(byte, chunk, sizeof(m_arena_chunk_t) + chunk->alloc,
+                sizeof(m_arena_chunk_t) + chunk->used, false);
+            chunk->alloc = chunk->used;
+            chunk = NULL;
+        } else {
+            chunk->alloc = chunk->used + num_bytes;
+        }
+    }
+
+    if (chunk == NULL) {
+        size_t alloc = MAX(num_bytes, MICROPY_ALLOC_ARENA_CHUNK);
+        chunk = m_malloc(sizeof(m_arena_chunk_t) + alloc, false);
+        chunk->next = arena->chunk;
+        chunk->alloc = alloc;
+        chunk->used = 0;
+        arena->chunk = chunk;
+    }
+
+    void *ptr = (byte*)chunk->data + chunk->used;
+    chunk->used += num_bytes;
+    memset(ptr, 0, num_bytes);
+    return ptr;
+}
+
+void m_arena_free(m_arena_t *arena) {
+    for (m_arena_chunk_t *chunk = arena->chunk; chunk != NULL;) {
+        m_arena_chunk_t *next = chunk->next;
+        m_del_var(m_arena_chunk_t, byte, chunk->alloc, chunk);
+        chunk = next;
+    }
+    arena->chunk = NULL;
+}
+
 #if MICROPY_MEM_STATS
 size_t m_get_total_bytes_allocated(void) {
     return MP_STATE_MEM(total_bytes_allocated);
@@ -51,6 +51,29 @@ const mp_map_t mp_const_empty_map = {
     .table = NULL,
 };
 
+#if MICROPY_OPT_LOAD_GLOBAL_CACHE
+// Globals dicts and the builtins are watched by the load global cache, which
+// must be invalidated when keys are added or removed, or the table moves.
+#define MAP_KEYS_CHANGED(map) do { \
+        if ((map)->is_watched) { \
+            MP_STATE_VM(load_global_cache_version) += 1; \
+        } \
+    } while (0)
+#else
+#define MAP_KEYS_CHANGED(map) (void)0
+#endif
+
+#if MICROPY_OPT_MAP_LOOKUP_CACHE
+// Ordered maps are searched linearly, so the slot where a qstr was last found
+// in one is remembered, keyed by the table and the qstr.  All maps share the
+// cache and a hint is only used if the slot still holds that qstr, so entries
+// never go stale even for maps that change or live on the stack.
+STATIC inline uint8_t *map_lookup_cache_entry(const mp_map_t *map, mp_obj_t index) {
+    uintptr_t h = ((uintptr_t)map->table >> 3) ^ (MP_OBJ_QSTR_VALUE(index) * 5);
+    return &MP_STATE_VM(map_lookup_cache)[h & (MICROPY_OPT_MAP_LOOKUP_CACHE_SIZE - 1)];
+}
+#endif
+
 // This table of sizes is used to control the growth of hash tables.
 // The first set of sizes are chosen so the allocation fits exactly in a
 // 4-word GC block, and it's not so important for these small values to be
@@ -88,6 +111,7 @@ void mp_map_init(mp_map_t *map, size_t n) {
     map->all_keys_are_qstrs = 1;
     map->is_fixed = 0;
     map->is_ordered = 0;
+    map->is_watched = 0;
 }
 
 void mp_map_init_fixed_table(mp_map_t *map, size_t n, const mp_obj_t *table) {
@@ -96,6 +120,7 @@ void mp_map_init_fixed_table(mp_map_t *map, size_t n, const mp_obj_t *table) {
     map->all_keys_are_qstrs = 1;
     map->is_fixed = 1;
     map->is_ordered = 1;
+    map->is_watched = 0;
     map->table = (mp_map_elem_t*)table;
 }
 
@@ -108,6 +133,7 @@ void mp_map_deinit(mp_map_t *map) {
 }
 
 void mp_map_clear(mp_map_t *map) {
+    MAP_KEYS_CHANGED(map);
     if (!map->is_fixed) {
         m_del(mp_map_elem_t, map->table, map->alloc);
     }
@@ -122,6 +148,7 @@ STATIC void mp_map_rehash(mp_map_t *map) {
     size_t old_alloc = map->alloc;
     size_t new_alloc = get_hash_alloc_greater_or_equal_to(map->alloc + 1);
     DEBUG_printf("mp_map_rehash(%p): " UINT_FMT " -> " UINT_FMT "\n", map, old_alloc, new_alloc);
+    MAP_KEYS_CHANGED(map);
     mp_map_elem_t *old_table = map->table;
     mp_map_elem_t *new_table = m_new0(mp_map_elem_t, new_alloc);
     // If we reach this point, table resizing succeeded, now we can edit the old map.
@@ -168,11 +195,26 @@ mp_map_elem_t *mp_map_lookup(mp_map_t *map, mp_obj_t index, mp_map_lookup_kind_t
 
     // if the map is an ordered array then we must do a brute force linear search
     if (map->is_ordered) {
+        #if MICROPY_OPT_MAP_LOOKUP_CACHE
+        uint8_t *hint = NULL;
+        if (compare_only_ptrs && lookup_kind == MP_MAP_LOOKUP) {
+            hint = map_lookup_cache_entry(map, index);
+            if (*hint < map->used && map->table[*hint].key == index) {
+                return &map->table[*hint];
+            }
+        }
+        #endif
         for (mp_map_elem_t *elem = &map->table[0], *top = &map->table[map->used]; elem < top; elem++) {
             if (elem->key == index || (!compare_only_ptrs && mp_obj_equal(elem->key, index))) {
+                #if MICROPY_OPT_MAP_LOOKUP_CACHE
+                if (hint != NULL && elem - map->table <= 0xff) {
+                    *hint = elem - map->table;
+                }
+                #endif
                 #if MICROPY_PY_COLLECTIONS_ORDEREDDICT
                 if (MP_UNLIKELY(lookup_kind == MP_MAP_LOOKUP_REMOVE_IF_FOUND)) {
                     // remove the found element by moving the rest of the array down
+                    MAP_KEYS_CHANGED(map);
                     mp_obj_t value = elem->value;
                     --map->used;
                     memmove(elem, elem + 1, (top - elem - 1) * sizeof(*elem));
@@ -195,6 +237,7 @@ mp_map_elem_t *mp_map_lookup(mp_map_t *map, mp_obj_t index, mp_map_lookup_kind_t
             map->table = m_renew(mp_map_elem_t, map->table, map->used, map->alloc);
             mp_seq_clear(map->table, map->used, map->alloc, sizeof(*map->table));
         }
+        MAP_KEYS_CHANGED(map);
         mp_map_elem_t *elem = map->table + map->used++;
         elem->key = index;
         if (!MP_OBJ_IS_QSTR(index)) {
@@ -232,6 +275,7 @@ mp_map_elem_t *mp_map_lookup(mp_map_t *map, mp_obj_t index, mp_map_lookup_kind_t
         if (slot->key == MP_OBJ_NULL) {
             // found NULL slot, so index is not in table
             if (lookup_kind == MP_MAP_LOOKUP_ADD_IF_NOT_FOUND) {
+                MAP_KEYS_CHANGED(map);
                 map->used += 1;
                 if (avail_slot == NULL) {
                     avail_slot = slot;
@@ -255,6 +299,7 @@ mp_map_elem_t *mp_map_lookup(mp_map_t *map, mp_obj_t index, mp_map_lookup_kind_t
             // Note: CPython does not replace the index; try x={True:'true'};x[1]='one';x
             if (lookup_kind == MP_MAP_LOOKUP_REMOVE_IF_FOUND) {
                 // delete element in this slot
+                MAP_KEYS_CHANGED(map);
                 map->used--;
                 if (map->table[(pos + 1) % map->alloc].key == MP_OBJ_NULL) {
                     // optimisation if next slot is empty
@@ -275,6 +320,7 @@ mp_map_elem_t *mp_map_lookup(mp_map_t *map, mp_obj_t index, mp_map_lookup_kind_t
             if (lookup_kind == MP_MAP_LOOKUP_ADD_IF_NOT_FOUND) {
                 if (avail_slot != NULL) {
                     // there was an available slot, so use that
+                    MAP_KEYS_CHANGED(map);
                     map->used++;
                     avail_slot->key = index;
                     avail_slot->value = MP_OBJ_NULL;
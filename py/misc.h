@@ -112,6 +112,21 @@ size_t m_get_current_bytes_allocated(void);
 size_t m_get_peak_bytes_allocated(void);
 #endif
 
+/** arena memory allocation *************************************/
+
+// An arena hands out zeroed memory from a chain of chunks on the heap, and
+// frees all of it at once, so short-lived allocations don't leave holes
+// between the longer-lived ones made at the same time.
+typedef struct _m_arena_t {
+    struct _m_arena_chunk_t *chunk;
+} m_arena_t;
+
+#define m_arena_new(arena, type, num) ((type*)(m_arena_alloc((arena), sizeof(type) * (num))))
+
+static inline void m_arena_init(m_arena_t *arena) { arena->chunk = NULL; }
+void *m_arena_alloc(m_arena_t *arena, size_t num_bytes);
+void m_arena_free(m_arena_t *arena);
+
 /** array helpers ***********************************************/
 
 // get the number of elements in a fixed-size array
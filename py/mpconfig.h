@@ -111,6 +111,13 @@
 #define MICROPY_ALLOC_GC_STACK_SIZE (64)
 #endif
 
+// Whether the GC counts the chains of blocks it traces in each collection, so
+// that tests can check that none is traced twice, even when the stack above
+// overflows.
+#ifndef MICROPY_GC_MARK_COUNT
+#define MICROPY_GC_MARK_COUNT (0)
+#endif
+
 // Be conservative and always clear to zero newly (re)allocated memory in the GC.
 // This helps eliminate stray pointers that hold on to memory that's no longer
 // used.  It decreases performance due to unnecessary memory clearing.
@@ -127,6 +134,54 @@
 #define MICROPY_GC_ALLOC_THRESHOLD (1)
 #endif
 
+// Keep a small cache of free block runs for each of the smallest allocation
+// sizes. gc_sweep refills it and gc_alloc pops from it instead of scanning the
+// allocation table, which stays the source of truth.
+#ifndef MICROPY_GC_FREE_LIST_CACHE
+#define MICROPY_GC_FREE_LIST_CACHE (0)
+#endif
+
+// Number of size classes cached; class n holds runs of n + 1 blocks.
+#ifndef MICROPY_GC_FREE_LIST_CLASSES
+#define MICROPY_GC_FREE_LIST_CLASSES (2)
+#endif
+
+// Number of entries cached for each size class.
+#ifndef MICROPY_GC_FREE_LIST_LEN
+#define MICROPY_GC_FREE_LIST_LEN (16)
+#endif
+
+// Sweep the heap in bounded steps after a collection triggered by gc_alloc,
+// instead of in one pass. gc_alloc sweeps lazily, just ahead of its search
+// for free space, and the rest is done by gc_sweep_step, which ports call
+// from their background tasks. Only the sweep is incremental: marking is not,
+// because it would need a write barrier on every pointer store, so the pause
+// for a collection still includes marking everything reachable in one go.
+// Finalisers are run by the collection too, never by a later sweep step.
+#ifndef MICROPY_GC_INCREMENTAL_SWEEP
+#define MICROPY_GC_INCREMENTAL_SWEEP (0)
+#endif
+
+// Number of blocks swept by each incremental sweep step. A step can go
+// further to finish the chain of blocks it stops in.
+#ifndef MICROPY_GC_SWEEP_STEP_BLOCKS
+#define MICROPY_GC_SWEEP_STEP_BLOCKS (1024)
+#endif
+
+// Provide gc_compact (and gc.compact), a full collection that also moves the
+// storage of bytearrays, arrays and lists to recover large free blocks. It
+// allocates a temporary table the size of the ATB to count references.
+#ifndef MICROPY_GC_COMPACT
+#define MICROPY_GC_COMPACT (0)
+#endif
+
+// Whether the VM keeps track of the running bytecode frames so that each
+// gc_alloc can be attributed to them. gc_alloc then calls
+// gc_alloc_profile_record, which the port must provide.
+#ifndef MICROPY_GC_ALLOC_PROFILE
+#define MICROPY_GC_ALLOC_PROFILE (0)
+#endif
+
 // Number of bytes to allocate initially when creating new chunks to store
 // interned string data.  Smaller numbers lead to more chunks being needed
 // and more wastage at the end of the chunk.  Larger numbers lead to wasted
@@ -141,6 +196,14 @@
 #define MICROPY_QSTR_POOL_MAX_ENTRIES (64)
 #endif
 
+// Whether to look up qstrs through hash indexes rather than by scanning every
+// pool.  The ROM pool uses a bucket table generated by makeqstrdata.py (about
+// 2.5 bytes of flash per qstr) and the pools in RAM share an open-addressing
+// table on the heap that grows with them (6 to 12 bytes per qstr).
+#ifndef MICROPY_QSTR_HASH_INDEX
+#define MICROPY_QSTR_HASH_INDEX (0)
+#endif
+
 // Initial amount for lexer indentation level
 #ifndef MICROPY_ALLOC_LEXER_INDENT_INIT
 #define MICROPY_ALLOC_LEXER_INDENT_INIT (10)
@@ -182,6 +245,13 @@
 #define MICROPY_ALLOC_PARSE_CHUNK_INIT (128)
 #endif
 
+// Number of bytes to allocate when starting a new chunk of an arena, such as
+// the one that holds the scopes and emitter state while compiling.  Chunks are
+// grown in place when they can be.
+#ifndef MICROPY_ALLOC_ARENA_CHUNK
+#define MICROPY_ALLOC_ARENA_CHUNK (256)
+#endif
+
 // Initial amount for ids in a scope
 #ifndef MICROPY_ALLOC_SCOPE_ID_INIT
 #define MICROPY_ALLOC_SCOPE_ID_INIT (4)
@@ -257,6 +327,16 @@
 #define MICROPY_PERSISTENT_CODE_SAVE (0)
 #endif
 
+// Whether .mpy files that can be mapped into memory run their bytecode in
+// place, with qstrs resolved through a per-module table instead of being
+// patched into a heap copy of the bytecode.  The filesystem must implement
+// map_file of the VFS protocol (or the port mp_reader_map_file).  Such bytecode
+// is never written to, so it doesn't get the caches of MICROPY_OPT_QUICKEN and
+// MICROPY_OPT_CACHE_MAP_LOOKUP_IN_BYTECODE.  Requires MICROPY_PERSISTENT_CODE_LOAD.
+#ifndef MICROPY_PERSISTENT_CODE_XIP
+#define MICROPY_PERSISTENT_CODE_XIP (0)
+#endif
+
 // Whether generated code can persist independently of the VM/runtime instance
 // This is enabled automatically when needed by other features
 #ifndef MICROPY_PERSISTENT_CODE
@@ -369,6 +449,15 @@
 #define MICROPY_COMP_RETURN_IF_EXPR (0)
 #endif
 
+// Whether imported .py modules are parsed, compiled and executed one top-level
+// statement at a time, so that peak memory use is set by the largest statement
+// rather than by the whole module.  The source file stays open while the
+// module executes, and a syntax error in a later statement is only raised once
+// the statements before it have been executed.
+#ifndef MICROPY_COMP_STREAMING
+#define MICROPY_COMP_STREAMING (0)
+#endif
+
 /*****************************************************************************/
 /* Internal debugging stuff                                                  */
 
@@ -407,6 +496,65 @@
 #define MICROPY_OPT_CACHE_MAP_LOOKUP_IN_BYTECODE (0)
 #endif
 
+// Whether to cache attribute lookups on types, keyed by the type and the name.
+// This saves searching the locals_dict of native types and walking the class
+// hierarchy of instances on each LOAD_ATTR, LOAD_METHOD and STORE_ATTR.  The
+// cache lives in the VM state rather than the bytecode so it also works for
+// frozen bytecode; it uses 3 words of RAM per entry.
+#ifndef MICROPY_OPT_TYPE_ATTR_CACHE
+#define MICROPY_OPT_TYPE_ATTR_CACHE (0)
+#endif
+
+// Number of entries in the type attribute cache, must be a power of 2
+#ifndef MICROPY_OPT_TYPE_ATTR_CACHE_SIZE
+#define MICROPY_OPT_TYPE_ATTR_CACHE_SIZE (32)
+#endif
+
+// Whether to remember where a qstr was last found in an ordered map, such as
+// the locals_dict of a native type or the globals of a builtin module.  Hits
+// skip the linear search of the table.  Each hint is checked against the table
+// before use so it never needs invalidating; it uses 1 byte of RAM per entry.
+#ifndef MICROPY_OPT_MAP_LOOKUP_CACHE
+#define MICROPY_OPT_MAP_LOOKUP_CACHE (0)
+#endif
+
+// Number of entries in the map lookup cache, must be a power of 2
+#ifndef MICROPY_OPT_MAP_LOOKUP_CACHE_SIZE
+#define MICROPY_OPT_MAP_LOOKUP_CACHE_SIZE (128)
+#endif
+
+// Whether to cache the result of LOAD_GLOBAL and LOAD_NAME per call site, so
+// that names found in the builtins don't cost a failed lookup in the globals
+// first.  Entries are checked against a version number that changes whenever
+// keys are added to or removed from a globals dict or the builtins.  The cache
+// lives in the VM state so it also works for frozen bytecode; it uses 4 words
+// of RAM per entry.
+#ifndef MICROPY_OPT_LOAD_GLOBAL_CACHE
+#define MICROPY_OPT_LOAD_GLOBAL_CACHE (0)
+#endif
+
+// Number of entries in the load global cache, must be a power of 2
+#ifndef MICROPY_OPT_LOAD_GLOBAL_CACHE_SIZE
+#define MICROPY_OPT_LOAD_GLOBAL_CACHE_SIZE (32)
+#endif
+
+// Whether the VM rewrites generic opcodes in RAM-resident bytecode into forms
+// specialised for the operand types it sees, such as small int addition,
+// float multiplication and list indexing by a small int.  Each specialised
+// form checks its operand types and reverts to the generic opcode when they
+// don't match.  Bytecode outside the GC heap, such as frozen bytecode, is
+// never rewritten.  Requires MICROPY_ENABLE_GC.
+#ifndef MICROPY_OPT_QUICKEN
+#define MICROPY_OPT_QUICKEN (0)
+#endif
+
+// Whether for loops over a range, list, tuple, bytes, bytearray, array or
+// memoryview keep a cursor in the value stack that FOR_ITER advances itself,
+// instead of building an iterator object and calling its iternext slot.
+#ifndef MICROPY_OPT_FOR_ITER_INLINE
+#define MICROPY_OPT_FOR_ITER_INLINE (0)
+#endif
+
 // Whether to use fast versions of bitwise operations (and, or, xor) when the
 // arguments are both positive.  Increases Thumb2 code size by about 250 bytes.
 #ifndef MICROPY_OPT_MPZ_BITWISE
@@ -433,6 +581,12 @@
 #define MICROPY_READER_VFS (0)
 #endif
 
+// Number of bytes the POSIX and VFS readers read from a file at a time.
+// Making this the sector size of the filesystem saves reads on small blocks.
+#ifndef MICROPY_READER_BUF_SIZE
+#define MICROPY_READER_BUF_SIZE (24)
+#endif
+
 // Number of VFS mounts to persist across soft-reset.
 #ifndef MICROPY_FATFS_NUM_PERSISTENT
 #define MICROPY_FATFS_NUM_PERSISTENT (0)
@@ -663,6 +817,17 @@ typedef double mp_float_t;
 #define MICROPY_MODULE_FROZEN (MICROPY_MODULE_FROZEN_STR || MICROPY_MODULE_FROZEN_MPY)
 #endif
 
+// Whether importing a .py file keeps its compiled code in a cache file next to
+// it (foo.py -> foo.mpc), stamped with the size and modification time of the
+// source, and loads that instead of compiling again while the source is
+// unchanged.  Requires MICROPY_PERSISTENT_CODE_LOAD and _SAVE, and a writable
+// filesystem.  A module is compiled whole when its cache file is written; if
+// the cache can't be written it is loaded as without the cache, so streamed
+// when MICROPY_COMP_STREAMING is enabled.
+#ifndef MICROPY_MODULE_CACHE
+#define MICROPY_MODULE_CACHE (0)
+#endif
+
 // Whether you can override builtins in the builtins module
 #ifndef MICROPY_CAN_OVERRIDE_BUILTINS
 #define MICROPY_CAN_OVERRIDE_BUILTINS (0)
@@ -741,6 +906,13 @@ typedef double mp_float_t;
 #define MICROPY_PY_DELATTR_SETATTR (0)
 #endif
 
+// Whether a class may declare __slots__ to give its instances a fixed
+// layout: attributes named there are stored in an array inside the instance
+// rather than in a map, and no other attributes can be added
+#ifndef MICROPY_PY_SLOTS
+#define MICROPY_PY_SLOTS (0)
+#endif
+
 // Support for async/await/async for/async with
 #ifndef MICROPY_PY_ASYNC_AWAIT
 #define MICROPY_PY_ASYNC_AWAIT (1)
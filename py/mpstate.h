@@ -60,6 +60,27 @@ typedef struct _mp_sched_item_t {
     mp_obj_t arg;
 } mp_sched_item_t;
 
+#if MICROPY_OPT_TYPE_ATTR_CACHE
+// Result of looking up attr on type; member is MP_OBJ_NULL if it wasn't found
+typedef struct _mp_type_attr_cache_entry_t {
+    const mp_obj_type_t *type;
+    qstr attr;
+    mp_obj_t member;
+} mp_type_attr_cache_entry_t;
+#endif
+
+#if MICROPY_OPT_LOAD_GLOBAL_CACHE
+// Where the name loaded at site, in the bytecode starting at code, was found
+// when globals was the globals dict
+typedef struct _mp_load_global_cache_entry_t {
+    const byte *code;
+    const byte *site;
+    mp_obj_dict_t *globals;
+    mp_map_elem_t *elem;
+    size_t version;
+} mp_load_global_cache_entry_t;
+#endif
+
 // This structure hold information about the memory allocation system.
 typedef struct _mp_state_mem_t {
     #if MICROPY_MEM_STATS
@@ -73,13 +94,21 @@ typedef struct _mp_state_mem_t {
     #if MICROPY_ENABLE_FINALISER
     byte *gc_finaliser_table_start;
     #endif
+    byte *gc_overflow_table_start;
     byte *gc_pool_start;
     byte *gc_pool_end;
 
     void *gc_lowest_long_lived_ptr;
 
     int gc_stack_overflow;
+    // Lowest and highest blocks that overflowed the stack while it was set.
+    size_t gc_stack_overflow_first;
+    size_t gc_stack_overflow_last;
     size_t gc_stack[MICROPY_ALLOC_GC_STACK_SIZE];
+    #if MICROPY_GC_MARK_COUNT
+    // Number of chains of blocks traced by the last collection.
+    size_t gc_mark_count;
+    #endif
     uint16_t gc_lock_depth;
 
     // This variable controls auto garbage collection.  If set to false then the
@@ -95,6 +124,28 @@ typedef struct _mp_state_mem_t {
     size_t gc_first_free_atb_index;
     size_t gc_last_free_atb_index;
 
+    #if MICROPY_GC_FREE_LIST_CACHE
+    // Start blocks of free runs found by the last sweep, lowest address first.
+    size_t gc_free_list[MICROPY_GC_FREE_LIST_CLASSES][MICROPY_GC_FREE_LIST_LEN];
+    uint16_t gc_free_list_next[MICROPY_GC_FREE_LIST_CLASSES];
+    uint16_t gc_free_list_len[MICROPY_GC_FREE_LIST_CLASSES];
+    // Block to continue from when refilling a size class.
+    size_t gc_free_list_scan[MICROPY_GC_FREE_LIST_CLASSES];
+    #endif
+
+    #if MICROPY_GC_INCREMENTAL_SWEEP
+    // Next block to sweep. A sweep is pending while this is below the number
+    // of blocks in the heap.
+    size_t gc_sweep_block;
+    // Set by gc_alloc so that the collection it triggers defers the sweep.
+    bool gc_sweep_defer;
+    #endif
+
+    #if MICROPY_GC_COMPACT
+    // Reference counts kept while gc_compact is collecting, otherwise NULL.
+    byte *gc_compact_refs;
+    #endif
+
     #if MICROPY_PY_GC_COLLECT_RETVAL
     size_t gc_collected;
     #endif
@@ -119,6 +170,11 @@ typedef struct _mp_state_vm_t {
 
     qstr_pool_t *last_pool;
 
+    #if MICROPY_QSTR_HASH_INDEX
+    // open-addressing index of the qstrs in the pools above the ROM pool
+    uint32_t *qstr_hash_table;
+    #endif
+
     // non-heap memory for creating an exception if we can't allocate RAM
     mp_obj_exception_t mp_emergency_exception_obj;
 
@@ -151,6 +207,17 @@ typedef struct _mp_state_vm_t {
     mp_sched_item_t sched_stack[MICROPY_SCHEDULER_DEPTH];
     #endif
 
+    #if MICROPY_OPT_TYPE_ATTR_CACHE
+    // these are root pointers so cached types can't be freed and reused
+    mp_type_attr_cache_entry_t type_attr_cache[MICROPY_OPT_TYPE_ATTR_CACHE_SIZE];
+    #endif
+
+    #if MICROPY_OPT_LOAD_GLOBAL_CACHE
+    // these are root pointers so cached bytecode and dicts can't be reused;
+    // code points to the start of the bytecode so that it keeps it alive
+    mp_load_global_cache_entry_t load_global_cache[MICROPY_OPT_LOAD_GLOBAL_CACHE_SIZE];
+    #endif
+
     // current exception being handled, for sys.exc_info()
     #if MICROPY_PY_SYS_EXC_INFO
     mp_obj_base_t *cur_exception;
@@ -191,6 +258,11 @@ typedef struct _mp_state_vm_t {
     struct _mp_vfs_mount_t *vfs_mount_table;
     #endif
 
+    #if MICROPY_READER_VFS
+    // a closed reader kept so the next import can reuse its buffer
+    struct _mp_reader_vfs_t *reader_vfs_spare;
+    #endif
+
     //
     // END ROOT POINTER SECTION
     ////////////////////////////////////////////////////////////
@@ -200,6 +272,19 @@ typedef struct _mp_state_vm_t {
     byte *qstr_last_chunk;
     size_t qstr_last_alloc;
     size_t qstr_last_used;
+    #if MICROPY_QSTR_HASH_INDEX
+    size_t qstr_hash_alloc;
+    #endif
+
+    #if MICROPY_OPT_MAP_LOOKUP_CACHE
+    // slot of the last hit in an ordered map, see mp_map_lookup
+    uint8_t map_lookup_cache[MICROPY_OPT_MAP_LOOKUP_CACHE_SIZE];
+    #endif
+
+    #if MICROPY_OPT_LOAD_GLOBAL_CACHE
+    // changed whenever the keys of a map with is_watched set change
+    size_t load_global_cache_version;
+    #endif
 
     #if MICROPY_PY_THREAD
     // This is a global mutex used to make qstr interning thread-safe.
@@ -246,6 +331,11 @@ typedef struct _mp_state_thread_t {
     uint8_t *pystack_cur;
     #endif
 
+    #if MICROPY_GC_ALLOC_PROFILE
+    // The innermost bytecode function being executed, or NULL.
+    struct _mp_code_state_t *current_code_state;
+    #endif
+
     ////////////////////////////////////////////////////////////
     // START ROOT POINTER SECTION
     // Everything that needs GC scanning must start here, and
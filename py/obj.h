@@ -368,7 +368,8 @@ typedef struct _mp_map_t {
     size_t is_ordered : 1;  // an ordered array
     size_t scanning : 1;    // true if we're in the middle of scanning linked dictionaries,
                             // e.g., make_dict_long_lived()
-    size_t used : (8 * sizeof(size_t) - 4);
+    size_t is_watched : 1;  // adding or removing keys invalidates the load global cache
+    size_t used : (8 * sizeof(size_t) - 5);
     size_t alloc;
     mp_map_elem_t *table;
 } mp_map_t;
@@ -559,6 +560,7 @@ extern const mp_obj_type_t mp_type_enumerate;
 extern const mp_obj_type_t mp_type_filter;
 extern const mp_obj_type_t mp_type_deque;
 extern const mp_obj_type_t mp_type_dict;
+extern const mp_obj_type_t mp_type_dict_view_it;
 extern const mp_obj_type_t mp_type_ordereddict;
 extern const mp_obj_type_t mp_type_range;
 extern const mp_obj_type_t mp_type_set;
@@ -785,6 +787,14 @@ mp_obj_t mp_obj_dict_store(mp_obj_t self_in, mp_obj_t key, mp_obj_t value);
 mp_obj_t mp_obj_dict_delete(mp_obj_t self_in, mp_obj_t key);
 mp_map_t *mp_obj_dict_get_map(mp_obj_t self_in);
 
+// enumerate, zip and dict.items() iterators
+// These store the next n values in items in reverse order, like mp_unpack_sequence,
+// without making a tuple.  They return mp_const_none, MP_OBJ_STOP_ITERATION when
+// the iterator is exhausted, or MP_OBJ_NULL if the iterator doesn't give n values.
+mp_obj_t mp_obj_enumerate_iternext_unpack(mp_obj_t self_in, size_t n, mp_obj_t *items);
+mp_obj_t mp_obj_zip_iternext_unpack(mp_obj_t self_in, size_t n, mp_obj_t *items);
+mp_obj_t mp_obj_dict_view_it_iternext_unpack(mp_obj_t self_in, size_t n, mp_obj_t *items);
+
 // set
 void mp_obj_set_store(mp_obj_t self_in, mp_obj_t item);
 
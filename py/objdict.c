@@ -314,6 +314,11 @@ STATIC mp_obj_t dict_popitem(mp_obj_t self_in) {
     if (next == NULL) {
         mp_raise_msg(&mp_type_KeyError, translate("popitem(): dictionary is empty"));
     }
+    #if MICROPY_OPT_LOAD_GLOBAL_CACHE
+    if (self->map.is_watched) {
+        MP_STATE_VM(load_global_cache_version) += 1;
+    }
+    #endif
     self->map.used--;
     mp_obj_t items[] = {next->key, next->value};
     next->key = MP_OBJ_SENTINEL; // must mark key as sentinel to indicate that it was deleted
@@ -379,7 +384,6 @@ STATIC MP_DEFINE_CONST_FUN_OBJ_KW(dict_update_obj, 1, dict_update);
 /* dict views                                                                 */
 
 STATIC const mp_obj_type_t dict_view_type;
-STATIC const mp_obj_type_t dict_view_it_type;
 
 typedef enum _mp_dict_view_kind_t {
     MP_DICT_VIEW_ITEMS,
@@ -403,7 +407,7 @@ typedef struct _mp_obj_dict_view_t {
 } mp_obj_dict_view_t;
 
 STATIC mp_obj_t dict_view_it_iternext(mp_obj_t self_in) {
-    mp_check_self(MP_OBJ_IS_TYPE(self_in, &dict_view_it_type));
+    mp_check_self(MP_OBJ_IS_TYPE(self_in, &mp_type_dict_view_it));
     mp_obj_dict_view_it_t *self = MP_OBJ_TO_PTR(self_in);
     mp_map_elem_t *next = dict_iter_next(MP_OBJ_TO_PTR(self->dict), &self->cur);
 
@@ -424,7 +428,22 @@ STATIC mp_obj_t dict_view_it_iternext(mp_obj_t self_in) {
     }
 }
 
-STATIC const mp_obj_type_t dict_view_it_type = {
+mp_obj_t mp_obj_dict_view_it_iternext_unpack(mp_obj_t self_in, size_t n, mp_obj_t *items) {
+    assert(MP_OBJ_IS_TYPE(self_in, &mp_type_dict_view_it));
+    mp_obj_dict_view_it_t *self = MP_OBJ_TO_PTR(self_in);
+    if (self->kind != MP_DICT_VIEW_ITEMS || n != 2) {
+        return MP_OBJ_NULL;
+    }
+    mp_map_elem_t *next = dict_iter_next(MP_OBJ_TO_PTR(self->dict), &self->cur);
+    if (next == NULL) {
+        return MP_OBJ_STOP_ITERATION;
+    }
+    items[0] = next->value;
+    items[1] = next->key;
+    return mp_const_none;
+}
+
+const mp_obj_type_t mp_type_dict_view_it = {
     { &mp_type_type },
     .name = MP_QSTR_iterator,
     .getiter = mp_identity_getiter,
@@ -436,7 +455,7 @@ STATIC mp_obj_t dict_view_getiter(mp_obj_t view_in, mp_obj_iter_buf_t *iter_buf)
     mp_check_self(MP_OBJ_IS_TYPE(view_in, &dict_view_type));
     mp_obj_dict_view_t *view = MP_OBJ_TO_PTR(view_in);
     mp_obj_dict_view_it_t *o = (mp_obj_dict_view_it_t*)iter_buf;
-    o->base.type = &dict_view_it_type;
+    o->base.type = &mp_type_dict_view_it;
     o->kind = view->kind;
     o->dict = view->dict;
     o->cur = 0;
@@ -518,7 +537,7 @@ STATIC mp_obj_t dict_getiter(mp_obj_t self_in, mp_obj_iter_buf_t *iter_buf) {
     assert(sizeof(mp_obj_dict_view_it_t) <= sizeof(mp_obj_iter_buf_t));
     mp_check_self(MP_OBJ_IS_DICT_TYPE(self_in));
     mp_obj_dict_view_it_t *o = (mp_obj_dict_view_it_t*)iter_buf;
-    o->base.type = &dict_view_it_type;
+    o->base.type = &mp_type_dict_view_it;
     o->kind = MP_DICT_VIEW_KEYS;
     o->dict = self_in;
     o->cur = 0;
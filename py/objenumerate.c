@@ -89,4 +89,19 @@ STATIC mp_obj_t enumerate_iternext(mp_obj_t self_in) {
     }
 }
 
+mp_obj_t mp_obj_enumerate_iternext_unpack(mp_obj_t self_in, size_t n, mp_obj_t *items) {
+    assert(MP_OBJ_IS_TYPE(self_in, &mp_type_enumerate));
+    mp_obj_enumerate_t *self = MP_OBJ_TO_PTR(self_in);
+    if (n != 2) {
+        return MP_OBJ_NULL;
+    }
+    mp_obj_t next = mp_iternext(self->iter);
+    if (next == MP_OBJ_STOP_ITERATION) {
+        return MP_OBJ_STOP_ITERATION;
+    }
+    items[0] = next;
+    items[1] = MP_OBJ_NEW_SMALL_INT(self->cur++);
+    return mp_const_none;
+}
+
 #endif // MICROPY_PY_BUILTINS_ENUMERATE
@@ -167,7 +167,13 @@ qstr mp_obj_fun_get_name(mp_const_obj_t fun_in) {
     bc++; // skip n_pos_args
     bc++; // skip n_kwonly_args
     bc++; // skip n_def_pos_args
-    return mp_obj_code_get_name(bc);
+    qstr name = mp_obj_code_get_name(bc);
+    #if MICROPY_PERSISTENT_CODE_XIP
+    if (fun->qstr_table != NULL) {
+        name = fun->qstr_table[name];
+    }
+    #endif
+    return name;
 }
 
 #if MICROPY_CPYTHON_COMPAT
@@ -379,6 +385,9 @@ mp_obj_t mp_obj_new_fun_bc(mp_obj_t def_args_in, mp_obj_t def_kw_args, const byt
     o->globals = mp_globals_get();
     o->bytecode = code;
     o->const_table = const_table;
+    #if MICROPY_PERSISTENT_CODE_XIP
+    o->qstr_table = NULL;
+    #endif
     if (def_args != NULL) {
         memcpy(o->extra_args, def_args->items, n_def_args * sizeof(mp_obj_t));
     }
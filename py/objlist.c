@@ -28,8 +28,8 @@
 #include <assert.h>
 
 #include "py/objlist.h"
+#include "py/objstr.h"
 #include "py/runtime.h"
-#include "py/stackctrl.h"
 
 #include "supervisor/shared/translate.h"
 
@@ -289,35 +289,317 @@ STATIC mp_obj_t list_pop(size_t n_args, const mp_obj_t *args) {
     return ret;
 }
 
-STATIC void mp_quicksort(mp_obj_t *head, mp_obj_t *tail, mp_obj_t key_fn, mp_obj_t binop_less_result) {
-    MP_STACK_CHECK();
-    while (head < tail) {
-        mp_obj_t *h = head - 1;
-        mp_obj_t *t = tail;
-        mp_obj_t v = key_fn == MP_OBJ_NULL ? tail[0] : mp_call_function_1(key_fn, tail[0]); // get pivot using key_fn
-        for (;;) {
-            do ++h; while (h < t && mp_binary_op(MP_BINARY_OP_LESS, key_fn == MP_OBJ_NULL ? h[0] : mp_call_function_1(key_fn, h[0]), v) == binop_less_result);
-            do --t; while (h < t && mp_binary_op(MP_BINARY_OP_LESS, v, key_fn == MP_OBJ_NULL ? t[0] : mp_call_function_1(key_fn, t[0])) == binop_less_result);
-            if (h >= t) break;
-            mp_obj_t x = h[0];
-            h[0] = t[0];
-            t[0] = x;
+/******************************************************************************/
+/* sorting                                                                    */
+
+// The sort is a stable merge sort in the style of timsort: the list is split
+// into runs that are already in order (descending runs are reversed), short
+// runs are extended with binary insertion sort, and runs are merged pairwise
+// keeping the lengths of the pending runs roughly balanced.  A key function is
+// called once per item and the keys are moved along with the items.  A merge
+// copies the shorter of its two runs out to a temporary buffer, which is put
+// back if a comparison raises, so the list still holds all of its items.
+
+// What the keys are, to compare them without going through mp_binary_op
+#define LIST_SORT_OBJ (0)
+#define LIST_SORT_SMALL_INT (1)
+#define LIST_SORT_FLOAT (2)
+#define LIST_SORT_STR (3)
+
+// Runs shorter than this are extended with insertion sort
+#define LIST_SORT_MIN_MERGE (64)
+
+// The lengths of pending runs grow at least as fast as the Fibonacci numbers
+#define LIST_SORT_MAX_RUNS (sizeof(size_t) * 12)
+
+typedef struct _list_sort_t {
+    mp_obj_t *keys; // the same as items if there is no key function
+    mp_obj_t *items;
+    mp_obj_t *tmp; // room for tmp_alloc keys, followed by tmp_alloc items if there is a key function
+    size_t tmp_alloc;
+    // during a merge, entries [tmp_lo, tmp_hi) of tmp belong in the list at gap
+    size_t tmp_lo;
+    size_t tmp_hi;
+    size_t gap;
+    size_t n;
+    byte kind;
+    bool reverse;
+} list_sort_t;
+
+STATIC byte list_sort_kind(const mp_obj_t *keys, size_t n) {
+    size_t i = 0;
+    if (MP_OBJ_IS_SMALL_INT(keys[0])) {
+        while (i < n && MP_OBJ_IS_SMALL_INT(keys[i])) {
+            i++;
+        }
+        return i == n ? LIST_SORT_SMALL_INT : LIST_SORT_OBJ;
+    }
+    #if MICROPY_PY_BUILTINS_FLOAT
+    if (mp_obj_is_float(keys[0])) {
+        while (i < n && mp_obj_is_float(keys[i])) {
+            i++;
+        }
+        return i == n ? LIST_SORT_FLOAT : LIST_SORT_OBJ;
+    }
+    #endif
+    if (MP_OBJ_IS_STR(keys[0])) {
+        while (i < n && MP_OBJ_IS_STR(keys[i])) {
+            i++;
         }
-        mp_obj_t x = h[0];
-        h[0] = tail[0];
-        tail[0] = x;
-        // do the smaller recursive call first, to keep stack within O(log(N))
-        if (t - head < tail - h - 1) {
-            mp_quicksort(head, t, key_fn, binop_less_result);
-            head = h + 1;
+        return i == n ? LIST_SORT_STR : LIST_SORT_OBJ;
+    }
+    return LIST_SORT_OBJ;
+}
+
+// Whether a sorts before b
+STATIC bool list_sort_less(const list_sort_t *s, mp_obj_t a, mp_obj_t b) {
+    if (s->reverse) {
+        mp_obj_t t = a;
+        a = b;
+        b = t;
+    }
+    switch (s->kind) {
+        case LIST_SORT_SMALL_INT:
+            return MP_OBJ_SMALL_INT_VALUE(a) < MP_OBJ_SMALL_INT_VALUE(b);
+        #if MICROPY_PY_BUILTINS_FLOAT
+        case LIST_SORT_FLOAT:
+            return mp_obj_float_get(a) < mp_obj_float_get(b);
+        #endif
+        case LIST_SORT_STR: {
+            GET_STR_DATA_LEN(a, a_data, a_len);
+            GET_STR_DATA_LEN(b, b_data, b_len);
+            return mp_seq_cmp_bytes(MP_BINARY_OP_LESS, a_data, a_len, b_data, b_len);
+        }
+        default:
+            return mp_obj_is_true(mp_binary_op(MP_BINARY_OP_LESS, a, b));
+    }
+}
+
+// Index of the first item in [lo, hi) that key sorts before, or with
+// after_equal false, of the first item that doesn't sort before key
+STATIC size_t list_sort_bisect(const list_sort_t *s, mp_obj_t key, size_t lo, size_t hi, bool after_equal) {
+    while (lo < hi) {
+        size_t mid = lo + (hi - lo) / 2;
+        if (after_equal ? !list_sort_less(s, key, s->keys[mid]) : list_sort_less(s, s->keys[mid], key)) {
+            lo = mid + 1;
         } else {
-            mp_quicksort(h + 1, tail, key_fn, binop_less_result);
-            tail = t;
+            hi = mid;
+        }
+    }
+    return lo;
+}
+
+// Insertion sort of [lo, hi) where [lo, start) is already sorted
+STATIC void list_sort_insert(list_sort_t *s, size_t lo, size_t start, size_t hi) {
+    for (; start < hi; start++) {
+        mp_obj_t key = s->keys[start];
+        size_t pos = list_sort_bisect(s, key, lo, start, true);
+        memmove(s->keys + pos + 1, s->keys + pos, (start - pos) * sizeof(mp_obj_t));
+        s->keys[pos] = key;
+        if (s->items != s->keys) {
+            mp_obj_t item = s->items[start];
+            memmove(s->items + pos + 1, s->items + pos, (start - pos) * sizeof(mp_obj_t));
+            s->items[pos] = item;
+        }
+    }
+}
+
+STATIC void list_sort_reverse(mp_obj_t *items, size_t lo, size_t hi) {
+    while (lo + 1 < hi) {
+        mp_obj_t t = items[lo];
+        items[lo++] = items[--hi];
+        items[hi] = t;
+    }
+}
+
+// Length of the run starting at lo, which is left in ascending order
+STATIC size_t list_sort_run(list_sort_t *s, size_t lo, size_t hi) {
+    size_t i = lo + 1;
+    if (i == hi) {
+        return 1;
+    }
+    if (list_sort_less(s, s->keys[i], s->keys[lo])) {
+        // strictly descending, so reversing it keeps equal items in order
+        while (++i < hi && list_sort_less(s, s->keys[i], s->keys[i - 1])) {
+        }
+        list_sort_reverse(s->keys, lo, i);
+        if (s->items != s->keys) {
+            list_sort_reverse(s->items, lo, i);
+        }
+    } else {
+        while (++i < hi && !list_sort_less(s, s->keys[i], s->keys[i - 1])) {
+        }
+    }
+    return i - lo;
+}
+
+// Make room in tmp for at least n keys, and n items if there is a key function
+STATIC void list_sort_tmp_reserve(list_sort_t *s, size_t n) {
+    if (n <= s->tmp_alloc) {
+        return;
+    }
+    size_t per_entry = s->items == s->keys ? 1 : 2;
+    if (s->tmp != NULL) {
+        m_del(mp_obj_t, s->tmp, per_entry * s->tmp_alloc);
+        s->tmp = NULL;
+    }
+    // the shorter of two runs is never more than half the list
+    n = MIN(MAX(n, 2 * s->tmp_alloc), s->n / 2);
+    s->tmp_alloc = 0;
+    s->tmp = m_new(mp_obj_t, per_entry * n);
+    s->tmp_alloc = n;
+}
+
+// Put the entries still held in tmp back into the list
+STATIC void list_sort_tmp_restore(list_sort_t *s) {
+    size_t n = s->tmp_hi - s->tmp_lo;
+    if (n > 0) {
+        memcpy(s->keys + s->gap, s->tmp + s->tmp_lo, n * sizeof(mp_obj_t));
+        if (s->items != s->keys) {
+            memcpy(s->items + s->gap, s->tmp + s->tmp_alloc + s->tmp_lo, n * sizeof(mp_obj_t));
         }
     }
+    s->tmp_lo = s->tmp_hi = 0;
+}
+
+// Merge the sorted runs [lo, mid) and [mid, hi)
+STATIC void list_sort_merge(list_sort_t *s, size_t lo, size_t mid, size_t hi) {
+    // items at either end that are already in their final place are skipped
+    lo = list_sort_bisect(s, s->keys[mid], lo, mid, true);
+    if (lo == mid) {
+        return;
+    }
+    hi = list_sort_bisect(s, s->keys[mid - 1], mid, hi, false);
+
+    // The shorter run is copied out to tmp, which leaves a gap in the list the
+    // size of what is still in tmp.  The gap is filled from the front when the
+    // left run is copied out and from the back when the right run is.
+    mp_obj_t *keys = s->keys;
+    mp_obj_t *items = s->items;
+    bool has_items = items != keys;
+    size_t n = MIN(mid - lo, hi - mid);
+    list_sort_tmp_reserve(s, n);
+    mp_obj_t *tmp_keys = s->tmp;
+    mp_obj_t *tmp_items = s->tmp + s->tmp_alloc;
+    if (mid - lo <= hi - mid) {
+        memcpy(tmp_keys, keys + lo, n * sizeof(mp_obj_t));
+        if (has_items) {
+            memcpy(tmp_items, items + lo, n * sizeof(mp_obj_t));
+        }
+        s->gap = lo;
+        s->tmp_hi = n;
+        size_t j = mid;
+        while (s->tmp_lo < s->tmp_hi && j < hi) {
+            size_t src = s->tmp_lo;
+            if (list_sort_less(s, keys[j], tmp_keys[src])) {
+                keys[s->gap] = keys[j];
+                if (has_items) {
+                    items[s->gap] = items[j];
+                }
+                j++;
+            } else {
+                keys[s->gap] = tmp_keys[src];
+                if (has_items) {
+                    items[s->gap] = tmp_items[src];
+                }
+                s->tmp_lo = src + 1;
+            }
+            s->gap++;
+        }
+    } else {
+        memcpy(tmp_keys, keys + mid, n * sizeof(mp_obj_t));
+        if (has_items) {
+            memcpy(tmp_items, items + mid, n * sizeof(mp_obj_t));
+        }
+        s->gap = mid;
+        s->tmp_hi = n;
+        while (s->tmp_hi > 0 && s->gap > lo) {
+            size_t src = s->tmp_hi - 1;
+            size_t i = s->gap - 1;
+            if (list_sort_less(s, tmp_keys[src], keys[i])) {
+                keys[i + s->tmp_hi] = keys[i];
+                if (has_items) {
+                    items[i + s->tmp_hi] = items[i];
+                }
+                s->gap = i;
+            } else {
+                keys[s->gap + src] = tmp_keys[src];
+                if (has_items) {
+                    items[s->gap + src] = tmp_items[src];
+                }
+                s->tmp_hi = src;
+            }
+        }
+    }
+    list_sort_tmp_restore(s);
+}
+
+STATIC size_t list_sort_min_run(size_t n) {
+    size_t r = 0;
+    while (n >= LIST_SORT_MIN_MERGE) {
+        r |= n & 1;
+        n >>= 1;
+    }
+    return n + r;
+}
+
+STATIC void list_sort(list_sort_t *s) {
+    s->kind = list_sort_kind(s->keys, s->n);
+    size_t min_run = list_sort_min_run(s->n);
+
+    // start of each pending run; run i ends where run i + 1 starts
+    size_t run[LIST_SORT_MAX_RUNS + 1];
+    size_t n_runs = 0;
+    size_t lo = 0;
+    while (lo < s->n) {
+        size_t len = list_sort_run(s, lo, s->n);
+        if (len < min_run) {
+            size_t hi = MIN(lo + min_run, s->n);
+            list_sort_insert(s, lo, lo + len, hi);
+            len = hi - lo;
+        }
+        run[n_runs++] = lo;
+        lo += len;
+        run[n_runs] = lo;
+
+        // merge until each run is longer than the two after it together
+        while (n_runs > 1) {
+            #define RUN_LEN(i) (run[(i) + 1] - run[i])
+            size_t m = n_runs - 2;
+            if ((m > 0 && RUN_LEN(m - 1) <= RUN_LEN(m) + RUN_LEN(m + 1))
+                || (m > 1 && RUN_LEN(m - 2) <= RUN_LEN(m - 1) + RUN_LEN(m))) {
+                if (RUN_LEN(m - 1) < RUN_LEN(m + 1)) {
+                    m -= 1;
+                }
+            } else if (RUN_LEN(m) > RUN_LEN(m + 1)) {
+                break;
+            }
+            #undef RUN_LEN
+            list_sort_merge(s, run[m], run[m + 1], run[m + 2]);
+            // runs m and m + 1 are now one
+            for (size_t i = m + 1; i < n_runs; i++) {
+                run[i] = run[i + 1];
+            }
+            n_runs -= 1;
+        }
+        assert(n_runs < LIST_SORT_MAX_RUNS);
+    }
+    while (n_runs > 1) {
+        list_sort_merge(s, run[n_runs - 2], run[n_runs - 1], run[n_runs]);
+        run[n_runs - 1] = run[n_runs];
+        n_runs -= 1;
+    }
+}
+
+STATIC void list_sort_free(list_sort_t *s) {
+    if (s->tmp != NULL) {
+        m_del(mp_obj_t, s->tmp, s->keys == s->items ? s->tmp_alloc : 2 * s->tmp_alloc);
+    }
+    if (s->keys != s->items) {
+        m_del(mp_obj_t, s->keys, s->n);
+    }
 }
 
-// TODO Python defines sort to be stable but ours is not
 mp_obj_t mp_obj_list_sort(size_t n_args, const mp_obj_t *pos_args, mp_map_t *kw_args) {
     static const mp_arg_t allowed_args[] = {
         { MP_QSTR_key, MP_ARG_KW_ONLY | MP_ARG_OBJ, {.u_rom_obj = MP_ROM_PTR(&mp_const_none_obj)} },
@@ -335,9 +617,32 @@ mp_obj_t mp_obj_list_sort(size_t n_args, const mp_obj_t *pos_args, mp_map_t *kw_
     mp_obj_list_t *self = MP_OBJ_TO_PTR(pos_args[0]);
 
     if (self->len > 1) {
-        mp_quicksort(self->items, self->items + self->len - 1,
-                     args.key.u_obj == mp_const_none ? MP_OBJ_NULL : args.key.u_obj,
-                     args.reverse.u_bool ? mp_const_false : mp_const_true);
+        list_sort_t s;
+        s.items = self->items;
+        s.keys = self->items;
+        s.tmp = NULL;
+        s.tmp_alloc = 0;
+        s.tmp_lo = s.tmp_hi = 0;
+        s.n = self->len;
+        s.reverse = args.reverse.u_bool;
+        if (args.key.u_obj != mp_const_none) {
+            // call the key function once for each item
+            s.keys = m_new(mp_obj_t, s.n);
+            for (size_t i = 0; i < s.n; i++) {
+                s.keys[i] = mp_call_function_1(args.key.u_obj, s.items[i]);
+            }
+        }
+        nlr_buf_t nlr;
+        if (nlr_push(&nlr) == 0) {
+            list_sort(&s);
+            nlr_pop();
+        } else {
+            // a comparison raised, maybe in the middle of a merge
+            list_sort_tmp_restore(&s);
+            list_sort_free(&s);
+            nlr_jump(nlr.ret_val);
+        }
+        list_sort_free(&s);
     }
 
     return mp_const_none;
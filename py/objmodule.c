@@ -73,6 +73,10 @@ STATIC void module_attr(mp_obj_t self_in, qstr attr, mp_obj_t *dest) {
             if (dict == &mp_module_builtins_globals) {
                 if (MP_STATE_VM(mp_module_builtins_override_dict) == NULL) {
                     MP_STATE_VM(mp_module_builtins_override_dict) = MP_OBJ_TO_PTR(mp_obj_new_dict(1));
+                    #if MICROPY_OPT_LOAD_GLOBAL_CACHE
+                    // names stored here can shadow builtins already cached
+                    MP_STATE_VM(mp_module_builtins_override_dict)->map.is_watched = 1;
+                    #endif
                 }
                 dict = MP_STATE_VM(mp_module_builtins_override_dict);
             } else
@@ -27,20 +27,13 @@
 #include <stdlib.h>
 
 #include "py/runtime.h"
+#include "py/objrange.h"
 
 #include "supervisor/shared/translate.h"
 
 /******************************************************************************/
 /* range iterator                                                             */
 
-typedef struct _mp_obj_range_it_t {
-    mp_obj_base_t base;
-    // TODO make these values generic objects or something
-    mp_int_t cur;
-    mp_int_t stop;
-    mp_int_t step;
-} mp_obj_range_it_t;
-
 STATIC mp_obj_t range_it_iternext(mp_obj_t o_in) {
     mp_obj_range_it_t *o = MP_OBJ_TO_PTR(o_in);
     if ((o->step > 0 && o->cur < o->stop) || (o->step < 0 && o->cur > o->stop)) {
@@ -52,7 +45,7 @@ STATIC mp_obj_t range_it_iternext(mp_obj_t o_in) {
     }
 }
 
-STATIC const mp_obj_type_t range_it_type = {
+const mp_obj_type_t mp_type_range_it = {
     { &mp_type_type },
     .name = MP_QSTR_iterator,
     .getiter = mp_identity_getiter,
@@ -62,7 +55,7 @@ STATIC const mp_obj_type_t range_it_type = {
 STATIC mp_obj_t mp_obj_new_range_iterator(mp_int_t cur, mp_int_t stop, mp_int_t step, mp_obj_iter_buf_t *iter_buf) {
     assert(sizeof(mp_obj_range_it_t) <= sizeof(mp_obj_iter_buf_t));
     mp_obj_range_it_t *o = (mp_obj_range_it_t*)iter_buf;
-    o->base.type = &range_it_type;
+    o->base.type = &mp_type_range_it;
     o->cur = cur;
     o->stop = stop;
     o->step = step;
@@ -72,14 +65,6 @@ STATIC mp_obj_t mp_obj_new_range_iterator(mp_int_t cur, mp_int_t stop, mp_int_t
 /******************************************************************************/
 /* range                                                                      */
 
-typedef struct _mp_obj_range_t {
-    mp_obj_base_t base;
-    // TODO make these values generic objects or something
-    mp_int_t start;
-    mp_int_t stop;
-    mp_int_t step;
-} mp_obj_range_t;
-
 STATIC void range_print(const mp_print_t *print, mp_obj_t self_in, mp_print_kind_t kind) {
     (void)kind;
     mp_obj_range_t *self = MP_OBJ_TO_PTR(self_in);
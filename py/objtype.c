@@ -48,9 +48,6 @@
 #define ENABLE_SPECIAL_ACCESSORS \
     (MICROPY_PY_DESCRIPTORS  || MICROPY_PY_DELATTR_SETATTR || MICROPY_PY_BUILTINS_PROPERTY)
 
-#define TYPE_FLAG_IS_SUBCLASSED (0x0001)
-#define TYPE_FLAG_HAS_SPECIAL_ACCESSORS (0x0002)
-
 STATIC mp_obj_t static_class_method_make_new(const mp_obj_type_t *self_in, size_t n_args, const mp_obj_t *args, mp_map_t *kw_args);
 
 /******************************************************************************/
@@ -104,6 +101,19 @@ STATIC MP_DEFINE_CONST_FUN_OBJ_KW(native_base_init_wrapper_obj, 1, native_base_i
 STATIC
 #endif
 mp_obj_instance_t *mp_obj_new_instance(const mp_obj_type_t *class, const mp_obj_type_t **native_base) {
+    #if MICROPY_PY_SLOTS
+    if (mp_obj_type_has_slots(class)) {
+        // Classes with slots never have a native base
+        size_t n_slots = ((const mp_obj_slots_type_t*)class)->n_slots;
+        mp_obj_slots_instance_t *o = m_new_obj_var(mp_obj_slots_instance_t, mp_obj_t, n_slots);
+        o->base.type = class;
+        for (size_t i = 0; i < n_slots; ++i) {
+            o->slots[i] = MP_OBJ_NULL;
+        }
+        *native_base = NULL;
+        return (mp_obj_instance_t*)o;
+    }
+    #endif
     size_t num_native_bases = instance_count_native_bases(class, native_base);
     assert(num_native_bases < 2);
     mp_obj_instance_t *o = m_new_obj_var(mp_obj_instance_t, mp_obj_t, num_native_bases);
@@ -118,6 +128,15 @@ mp_obj_instance_t *mp_obj_new_instance(const mp_obj_type_t *class, const mp_obj_
     return o;
 }
 
+#if MICROPY_PY_SLOTS
+// Return the slot of self that holds attr, or NULL if attr isn't one of them
+STATIC mp_obj_t *instance_slot(mp_obj_t self_in, qstr attr) {
+    mp_obj_slots_instance_t *self = MP_OBJ_TO_PTR(self_in);
+    mp_int_t i = mp_obj_type_slot_index(self->base.type, attr);
+    return i < 0 ? NULL : &self->slots[i];
+}
+#endif
+
 // When instances are first created they have the base_init wrapper as their native parent's
 // instance because make_new combines __new__ and __init__. This object is invalid for the native
 // code so it must call this method to ensure that the given object has been __init__'d and is
@@ -148,6 +167,9 @@ struct class_lookup_data {
     size_t meth_offset;
     mp_obj_t *dest;
     bool is_type;
+    #if MICROPY_OPT_TYPE_ATTR_CACHE
+    mp_obj_t member; // the value found in a locals_dict, before any binding
+    #endif
 };
 
 STATIC void mp_obj_class_lookup(struct class_lookup_data  *lookup, const mp_obj_type_t *type) {
@@ -177,6 +199,9 @@ STATIC void mp_obj_class_lookup(struct class_lookup_data  *lookup, const mp_obj_
             mp_map_t *locals_map = &type->locals_dict->map;
             mp_map_elem_t *elem = mp_map_lookup(locals_map, MP_OBJ_NEW_QSTR(lookup->attr), MP_MAP_LOOKUP);
             if (elem != NULL) {
+                #if MICROPY_OPT_TYPE_ATTR_CACHE
+                lookup->member = elem->value;
+                #endif
                 if (lookup->is_type) {
                     // If we look up a class method, we need to return original type for which we
                     // do a lookup, not a (base) type in which we found the class method.
@@ -253,6 +278,102 @@ STATIC void mp_obj_class_lookup(struct class_lookup_data  *lookup, const mp_obj_
     }
 }
 
+#if MICROPY_OPT_TYPE_ATTR_CACHE
+
+// Attribute lookups in the locals_dict of native types, and in the class
+// hierarchy of instance types, are remembered in a small cache keyed by the
+// type and the name.  Storing to or deleting from the locals_dict of any type
+// clears the whole cache.
+
+STATIC mp_type_attr_cache_entry_t *type_attr_cache_entry(const mp_obj_type_t *type, qstr attr) {
+    size_t i = ((uintptr_t)type >> 3) ^ (attr * 5);
+    return &MP_STATE_VM(type_attr_cache)[i & (MICROPY_OPT_TYPE_ATTR_CACHE_SIZE - 1)];
+}
+
+void mp_obj_type_attr_cache_clear(void) {
+    memset(MP_STATE_VM(type_attr_cache), 0, sizeof(MP_STATE_VM(type_attr_cache)));
+}
+
+mp_obj_t mp_obj_type_locals_lookup(const mp_obj_type_t *type, qstr attr) {
+    mp_type_attr_cache_entry_t *entry = type_attr_cache_entry(type, attr);
+    if (entry->type != type || entry->attr != attr) {
+        mp_map_elem_t *elem = mp_map_lookup(&type->locals_dict->map, MP_OBJ_NEW_QSTR(attr), MP_MAP_LOOKUP);
+        entry->type = type;
+        entry->attr = attr;
+        entry->member = elem != NULL ? elem->value : MP_OBJ_NULL;
+    }
+    return entry->member;
+}
+
+// Same as mp_obj_class_lookup for an instance of type, using the cache when
+// the type has no native base.  Then the member can only come from the
+// locals_dict of a Python class and the result only depends on the member.
+STATIC void mp_obj_class_lookup_cached(struct class_lookup_data *lookup, const mp_obj_type_t *type) {
+    mp_type_attr_cache_entry_t *entry = type_attr_cache_entry(type, lookup->attr);
+    if (entry->type == type && entry->attr == lookup->attr) {
+        if (entry->member == MP_OBJ_NULL) {
+            // not found
+        } else if (MP_OBJ_IS_TYPE(entry->member, &mp_type_property)) {
+            lookup->dest[0] = entry->member;
+        } else {
+            mp_convert_member_lookup(MP_OBJ_FROM_PTR(lookup->obj), type, entry->member, lookup->dest);
+        }
+        return;
+    }
+    lookup->member = MP_OBJ_NULL;
+    mp_obj_class_lookup(lookup, type);
+    const mp_obj_type_t *native_base;
+    if (instance_count_native_bases(type, &native_base) == 0) {
+        entry->type = type;
+        entry->attr = lookup->attr;
+        entry->member = lookup->member;
+    }
+}
+
+mp_obj_t mp_obj_load_method_cached(mp_obj_t obj, qstr attr) {
+    const mp_obj_type_t *type = mp_obj_get_type(obj);
+    mp_obj_t member;
+    if (attr == MP_QSTR___class__) {
+        return MP_OBJ_NULL;
+    } else if (mp_obj_is_instance_type(type)) {
+        if (type->flags & TYPE_FLAG_HAS_SPECIAL_ACCESSORS) {
+            return MP_OBJ_NULL;
+        }
+        #if MICROPY_PY_SLOTS
+        if (mp_obj_type_has_slots(type)) {
+            mp_obj_t *slot = instance_slot(obj, attr);
+            if (slot != NULL && *slot != MP_OBJ_NULL) {
+                return MP_OBJ_NULL;
+            }
+        } else
+        #endif
+        {
+            mp_obj_instance_t *self = MP_OBJ_TO_PTR(obj);
+            if (mp_map_lookup(&self->members, MP_OBJ_NEW_QSTR(attr), MP_MAP_LOOKUP) != NULL) {
+                return MP_OBJ_NULL;
+            }
+        }
+        mp_type_attr_cache_entry_t *entry = type_attr_cache_entry(type, attr);
+        if (entry->type != type || entry->attr != attr) {
+            return MP_OBJ_NULL;
+        }
+        member = entry->member;
+    } else if (type->attr == NULL && type->locals_dict != NULL
+        && !(attr == MP_QSTR___next__ && type->iternext != NULL)) {
+        member = mp_obj_type_locals_lookup(type, attr);
+    } else {
+        return MP_OBJ_NULL;
+    }
+    if (member == MP_OBJ_NULL || !MP_OBJ_IS_FUN(member)) {
+        return MP_OBJ_NULL;
+    }
+    return member;
+}
+
+#else
+#define mp_obj_class_lookup_cached mp_obj_class_lookup
+#endif
+
 STATIC void instance_print(const mp_print_t *print, mp_obj_t self_in, mp_print_kind_t kind) {
     mp_obj_instance_t *self = MP_OBJ_TO_PTR(self_in);
     qstr meth = (kind == PRINT_STR) ? MP_QSTR___str__ : MP_QSTR___repr__;
@@ -421,6 +542,12 @@ STATIC mp_obj_t instance_unary_op(mp_unary_op_t op, mp_obj_t self_in) {
 
     #if MICROPY_PY_SYS_GETSIZEOF
     if (MP_UNLIKELY(op == MP_UNARY_OP_SIZEOF)) {
+        #if MICROPY_PY_SLOTS
+        if (mp_obj_type_has_slots(self->base.type)) {
+            const mp_obj_slots_type_t *type = (const mp_obj_slots_type_t*)self->base.type;
+            return MP_OBJ_NEW_SMALL_INT(sizeof(mp_obj_slots_instance_t) + sizeof(mp_obj_t) * type->n_slots);
+        }
+        #endif
         // TODO: This doesn't count inherited objects (self->subobj)
         const mp_obj_type_t *native_base;
         size_t num_native_bases = instance_count_native_bases(mp_obj_get_type(self_in), &native_base);
@@ -597,6 +724,17 @@ STATIC void mp_obj_instance_load_attr(mp_obj_t self_in, qstr attr, mp_obj_t *des
     assert(mp_obj_is_instance_type(mp_obj_get_type(self_in)));
     mp_obj_instance_t *self = MP_OBJ_TO_PTR(self_in);
 
+    #if MICROPY_PY_SLOTS
+    if (mp_obj_type_has_slots(self->base.type)) {
+        mp_obj_t *slot = instance_slot(self_in, attr);
+        if (slot != NULL && *slot != MP_OBJ_NULL) {
+            dest[0] = *slot;
+            return;
+        }
+        goto lookup_class;
+    }
+    #endif
+
     mp_map_elem_t *elem = mp_map_lookup(&self->members, MP_OBJ_NEW_QSTR(attr), MP_MAP_LOOKUP);
     if (elem != NULL) {
         // object member, always treated as a value
@@ -619,6 +757,9 @@ STATIC void mp_obj_instance_load_attr(mp_obj_t self_in, qstr attr, mp_obj_t *des
         return;
     }
 #endif
+    #if MICROPY_PY_SLOTS
+lookup_class:;
+    #endif
     struct class_lookup_data lookup = {
         .obj = self,
         .attr = attr,
@@ -626,7 +767,7 @@ STATIC void mp_obj_instance_load_attr(mp_obj_t self_in, qstr attr, mp_obj_t *des
         .dest = dest,
         .is_type = false,
     };
-    mp_obj_class_lookup(&lookup, self->base.type);
+    mp_obj_class_lookup_cached(&lookup, self->base.type);
     mp_obj_t member = dest[0];
     if (member != MP_OBJ_NULL) {
         // changes here may may require changes to super_attr, below
@@ -713,7 +854,7 @@ STATIC bool mp_obj_instance_store_attr(mp_obj_t self_in, qstr attr, mp_obj_t val
         .dest = member,
         .is_type = false,
     };
-    mp_obj_class_lookup(&lookup, self->base.type);
+    mp_obj_class_lookup_cached(&lookup, self->base.type);
 
     if (member[0] != MP_OBJ_NULL) {
         #if MICROPY_PY_BUILTINS_PROPERTY
@@ -805,6 +946,17 @@ STATIC bool mp_obj_instance_store_attr(mp_obj_t self_in, qstr attr, mp_obj_t val
 
 skip_special_accessors:
 
+    #if MICROPY_PY_SLOTS
+    if (mp_obj_type_has_slots(self->base.type)) {
+        mp_obj_t *slot = instance_slot(self_in, attr);
+        if (slot == NULL || (value == MP_OBJ_NULL && *slot == MP_OBJ_NULL)) {
+            return false;
+        }
+        *slot = value;
+        return true;
+    }
+    #endif
+
     if (value == MP_OBJ_NULL) {
         // delete attribute
         mp_map_elem_t *elem = mp_map_lookup(&self->members, MP_OBJ_NEW_QSTR(attr), MP_MAP_LOOKUP_REMOVE_IF_FOUND);
@@ -1079,6 +1231,9 @@ STATIC void type_attr(mp_obj_t self_in, qstr attr, mp_obj_t *dest) {
                 // can't apply delete/store to a fixed map
                 return;
             }
+            #if MICROPY_OPT_TYPE_ATTR_CACHE
+            mp_obj_type_attr_cache_clear();
+            #endif
             if (dest[1] == MP_OBJ_NULL) {
                 // delete attribute
                 mp_map_elem_t *elem = mp_map_lookup(locals_map, MP_OBJ_NEW_QSTR(attr), MP_MAP_LOOKUP_REMOVE_IF_FOUND);
@@ -1118,6 +1273,75 @@ const mp_obj_type_t mp_type_type = {
     .attr = type_attr,
 };
 
+#if MICROPY_PY_SLOTS
+// Return the base class whose slots come first in the instances of a class
+// with the given bases, or NULL if none of them has any slots.  Only one
+// base may bring slots with it.  *fixed is set to whether all the bases
+// have a fixed instance layout.
+STATIC const mp_obj_slots_type_t *type_slots_base(size_t bases_len, mp_obj_t *bases_items, bool *fixed) {
+    const mp_obj_slots_type_t *base = NULL;
+    *fixed = true;
+    for (size_t i = 0; i < bases_len; i++) {
+        const mp_obj_type_t *t = MP_OBJ_TO_PTR(bases_items[i]);
+        if (t == &mp_type_object) {
+            continue;
+        }
+        if (!mp_obj_is_instance_type(t) || !mp_obj_type_has_slots(t)) {
+            *fixed = false;
+            continue;
+        }
+        const mp_obj_slots_type_t *st = (const mp_obj_slots_type_t*)t;
+        if (st->n_slots == 0) {
+            continue;
+        }
+        if (base != NULL && (base->n_slots != st->n_slots
+            || memcmp(base->slot_names, st->slot_names, st->n_slots * sizeof(qstr)) != 0)) {
+            mp_raise_TypeError(translate("multiple bases have instance lay-out conflict"));
+        }
+        base = st;
+    }
+    return base;
+}
+
+// Make the class object for a class whose locals define __slots__, giving
+// its instances a fixed layout that starts with the slots of base.  Returns
+// NULL if __dict__ is one of the slots, as the instances need a members map.
+STATIC mp_obj_type_t *type_new_with_slots(mp_obj_t slots_in, const mp_obj_slots_type_t *base) {
+    size_t len;
+    mp_obj_t *items;
+    if (MP_OBJ_IS_STR(slots_in)) {
+        len = 1;
+        items = &slots_in;
+    } else {
+        if (!MP_OBJ_IS_TYPE(slots_in, &mp_type_tuple) && !MP_OBJ_IS_TYPE(slots_in, &mp_type_list)) {
+            slots_in = mp_type_tuple.make_new(&mp_type_tuple, 1, &slots_in, NULL);
+        }
+        mp_obj_get_array(slots_in, &len, &items);
+    }
+
+    for (size_t i = 0; i < len; i++) {
+        if (mp_obj_str_get_qstr(items[i]) == MP_QSTR___dict__) {
+            return NULL;
+        }
+    }
+
+    size_t n_base = base == NULL ? 0 : base->n_slots;
+    mp_obj_slots_type_t *o = m_malloc0(sizeof(mp_obj_slots_type_t) + (n_base + len) * sizeof(qstr), true);
+    o->n_slots = n_base;
+    if (n_base != 0) {
+        memcpy(o->slot_names, base->slot_names, n_base * sizeof(qstr));
+    }
+    for (size_t i = 0; i < len; i++) {
+        qstr attr = mp_obj_str_get_qstr(items[i]);
+        if (mp_obj_type_slot_index(&o->type, attr) < 0) {
+            o->slot_names[o->n_slots++] = attr;
+        }
+    }
+    o->type.flags = TYPE_FLAG_HAS_SLOTS;
+    return &o->type;
+}
+#endif
+
 mp_obj_t mp_obj_new_type(qstr name, mp_obj_t bases_tuple, mp_obj_t locals_dict) {
     // Verify input objects have expected type
     if (!MP_OBJ_IS_TYPE(bases_tuple, &mp_type_tuple)) {
@@ -1156,9 +1380,21 @@ mp_obj_t mp_obj_new_type(qstr name, mp_obj_t bases_tuple, mp_obj_t locals_dict)
         #endif
     }
 
-    mp_obj_type_t *o = m_new0_ll(mp_obj_type_t, 1);
+    mp_obj_type_t *o = NULL;
+    #if MICROPY_PY_SLOTS
+    bool fixed_layout;
+    const mp_obj_slots_type_t *slots_base = type_slots_base(bases_len, bases_items, &fixed_layout);
+    mp_map_elem_t *slots = mp_map_lookup(mp_obj_dict_get_map(locals_dict), MP_OBJ_NEW_QSTR(MP_QSTR___slots__), MP_MAP_LOOKUP);
+    if (slots != NULL && fixed_layout) {
+        o = type_new_with_slots(slots->value, slots_base);
+    }
+    if (o == NULL)
+    #endif
+    {
+        o = m_new0_ll(mp_obj_type_t, 1);
+    }
     o->base.type = &mp_type_type;
-    o->flags = base_flags;
+    o->flags |= base_flags;
     o->name = name;
     o->print = instance_print;
     o->make_new = mp_obj_instance_make_new;
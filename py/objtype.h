@@ -37,6 +37,61 @@ typedef struct _mp_obj_instance_t {
     // TODO maybe cache __getattr__ and __setattr__ for efficient lookup of them
 } mp_obj_instance_t;
 
+// flags of classes defined in Python
+#define TYPE_FLAG_IS_SUBCLASSED (0x0001)
+#define TYPE_FLAG_HAS_SPECIAL_ACCESSORS (0x0002)
+#define TYPE_FLAG_HAS_SLOTS (0x0004)
+
+#if MICROPY_PY_SLOTS
+// a class with a fixed instance layout, holding the names of the slots of it
+// and its bases in the order they are stored in each instance
+typedef struct _mp_obj_slots_type_t {
+    mp_obj_type_t type;
+    size_t n_slots;
+    qstr slot_names[];
+} mp_obj_slots_type_t;
+
+// instance of a class with TYPE_FLAG_HAS_SLOTS; it has no members map, and
+// slots that have not been assigned to hold MP_OBJ_NULL
+typedef struct _mp_obj_slots_instance_t {
+    mp_obj_base_t base;
+    mp_obj_t slots[];
+} mp_obj_slots_instance_t;
+
+#define mp_obj_type_has_slots(type) ((type)->flags & TYPE_FLAG_HAS_SLOTS)
+
+// Return the index of attr among the slots of type, or -1 if it isn't one
+static inline mp_int_t mp_obj_type_slot_index(const mp_obj_type_t *type, qstr attr) {
+    const mp_obj_slots_type_t *st = (const mp_obj_slots_type_t*)type;
+    for (size_t i = 0; i < st->n_slots; ++i) {
+        if (st->slot_names[i] == attr) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+// Return the slot of self, an instance of a class with slots, that holds
+// attr, or NULL if attr isn't a slot.  *cache is tried as the slot index
+// first, and set to the index found.
+static inline mp_obj_t *mp_obj_instance_slot_cached(mp_obj_t self_in, qstr attr, byte *cache) {
+    mp_obj_slots_instance_t *self = MP_OBJ_TO_PTR(self_in);
+    const mp_obj_slots_type_t *type = (const mp_obj_slots_type_t*)self->base.type;
+    mp_uint_t x = *cache;
+    if (x >= type->n_slots || type->slot_names[x] != attr) {
+        mp_int_t i = mp_obj_type_slot_index(&type->type, attr);
+        if (i < 0) {
+            return NULL;
+        }
+        x = i;
+        *cache = x;
+    }
+    return &self->slots[x];
+}
+#else
+#define mp_obj_type_has_slots(type) (0)
+#endif
+
 void mp_obj_assert_native_inited(mp_obj_t native_object);
 
 #if MICROPY_CPYTHON_COMPAT
@@ -48,6 +103,15 @@ mp_obj_instance_t *mp_obj_new_instance(const mp_obj_type_t *cls, const mp_obj_ty
 bool mp_obj_instance_is_callable(mp_obj_t self_in);
 mp_obj_t mp_obj_instance_call(mp_obj_t self_in, size_t n_args, size_t n_kw, const mp_obj_t *args);
 
+#if MICROPY_OPT_TYPE_ATTR_CACHE
+void mp_obj_type_attr_cache_clear(void);
+// Look up attr in the locals_dict of type, which must not be NULL
+mp_obj_t mp_obj_type_locals_lookup(const mp_obj_type_t *type, qstr attr);
+// Return the function that mp_load_method would bind to obj when it can be
+// found cheaply through the cache, else MP_OBJ_NULL
+mp_obj_t mp_obj_load_method_cached(mp_obj_t obj, qstr attr);
+#endif
+
 #define mp_obj_is_instance_type(type) ((type)->make_new == mp_obj_instance_make_new)
 #define mp_obj_is_native_type(type) ((type)->make_new != mp_obj_instance_make_new)
 // this needs to be exposed for the above macros to work correctly
@@ -67,6 +67,25 @@ STATIC mp_obj_t zip_iternext(mp_obj_t self_in) {
     return MP_OBJ_FROM_PTR(tuple);
 }
 
+mp_obj_t mp_obj_zip_iternext_unpack(mp_obj_t self_in, size_t n, mp_obj_t *items) {
+    assert(MP_OBJ_IS_TYPE(self_in, &mp_type_zip));
+    mp_obj_zip_t *self = MP_OBJ_TO_PTR(self_in);
+    if (self->n_iters != n) {
+        return MP_OBJ_NULL;
+    }
+    if (n == 0) {
+        return MP_OBJ_STOP_ITERATION;
+    }
+    for (size_t i = 0; i < n; i++) {
+        mp_obj_t next = mp_iternext(self->iters[i]);
+        if (next == MP_OBJ_STOP_ITERATION) {
+            return MP_OBJ_STOP_ITERATION;
+        }
+        items[n - 1 - i] = next;
+    }
+    return mp_const_none;
+}
+
 const mp_obj_type_t mp_type_zip = {
     { &mp_type_type },
     .name = MP_QSTR_zip,
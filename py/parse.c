@@ -835,11 +835,10 @@ STATIC void push_result_rule(parser_t *parser, size_t src_line, uint8_t rule_id,
     push_result_node(parser, (mp_parse_node_t)pn);
 }
 
-mp_parse_tree_t mp_parse(mp_lexer_t *lex, mp_parse_input_kind_t input_kind) {
-
-    // initialise parser and allocate memory for its stacks
+STATIC void parser_init(parser_t *parser_in, mp_lexer_t *lex) {
+    #define parser (*parser_in)
 
-    parser_t parser;
+    // allocate memory for the parser stacks
 
     parser.rule_stack_alloc = MICROPY_ALLOC_PARSE_RULE_INIT;
     parser.rule_stack_top = 0;
@@ -870,20 +869,33 @@ mp_parse_tree_t mp_parse(mp_lexer_t *lex, mp_parse_input_kind_t input_kind) {
 
     parser.lexer = lex;
 
-    parser.tree.chunk = NULL;
-    parser.cur_chunk = NULL;
-
     #if MICROPY_COMP_CONST
     mp_map_init(&parser.consts, 0);
     #endif
 
-    // work out the top-level rule to use, and push it on the stack
-    size_t top_level_rule;
-    switch (input_kind) {
-        case MP_PARSE_SINGLE_INPUT: top_level_rule = RULE_single_input; break;
-        case MP_PARSE_EVAL_INPUT: top_level_rule = RULE_eval_input; break;
-        default: top_level_rule = RULE_file_input;
-    }
+    #undef parser
+}
+
+STATIC void parser_free(parser_t *parser) {
+    #if MICROPY_COMP_CONST
+    mp_map_deinit(&parser->consts);
+    #endif
+
+    // free the memory that we don't need anymore
+    m_del(rule_stack_t, parser->rule_stack, parser->rule_stack_alloc);
+    m_del(mp_parse_node_t, parser->result_stack, parser->result_stack_alloc);
+
+    // we also free the lexer on behalf of the caller
+    mp_lexer_free(parser->lexer);
+}
+
+// Parse the input for top_level_rule into parser->tree
+STATIC void parse_rule(parser_t *parser_in, size_t top_level_rule, mp_parse_input_kind_t input_kind) {
+    #define parser (*parser_in)
+    mp_lexer_t *lex = parser.lexer;
+
+    parser.tree.chunk = NULL;
+    parser.cur_chunk = NULL;
     push_rule(&parser, lex->tok_line, top_level_rule, 0);
 
     // parse!
@@ -1144,10 +1156,6 @@ mp_parse_tree_t mp_parse(mp_lexer_t *lex, mp_parse_input_kind_t input_kind) {
         }
     }
 
-    #if MICROPY_COMP_CONST
-    mp_map_deinit(&parser.consts);
-    #endif
-
     // truncate final chunk and link into chain of chunks
     if (parser.cur_chunk != NULL) {
         (void)m_renew_maybe(byte, parser.cur_chunk,
@@ -1160,7 +1168,7 @@ mp_parse_tree_t mp_parse(mp_lexer_t *lex, mp_parse_input_kind_t input_kind) {
     }
 
     if (
-        lex->tok_kind != MP_TOKEN_END // check we are at the end of the token stream
+        (lex->tok_kind != MP_TOKEN_END && top_level_rule != RULE_stmt) // check we are at the end of the token stream
         || parser.result_stack_top == 0 // check that we got a node (can fail on empty input)
         ) {
     syntax_error:;
@@ -1184,17 +1192,57 @@ mp_parse_tree_t mp_parse(mp_lexer_t *lex, mp_parse_input_kind_t input_kind) {
     // get the root parse node that we created
     assert(parser.result_stack_top == 1);
     parser.tree.root = parser.result_stack[0];
+    parser.result_stack_top = 0;
 
-    // free the memory that we don't need anymore
-    m_del(rule_stack_t, parser.rule_stack, parser.rule_stack_alloc);
-    m_del(mp_parse_node_t, parser.result_stack, parser.result_stack_alloc);
+    #undef parser
+}
 
-    // we also free the lexer on behalf of the caller
-    mp_lexer_free(lex);
+mp_parse_tree_t mp_parse(mp_lexer_t *lex, mp_parse_input_kind_t input_kind) {
+    parser_t parser;
+    parser_init(&parser, lex);
+
+    // work out the top-level rule to use, and parse the input
+    size_t top_level_rule;
+    switch (input_kind) {
+        case MP_PARSE_SINGLE_INPUT: top_level_rule = RULE_single_input; break;
+        case MP_PARSE_EVAL_INPUT: top_level_rule = RULE_eval_input; break;
+        default: top_level_rule = RULE_file_input;
+    }
+    parse_rule(&parser, top_level_rule, input_kind);
 
+    parser_free(&parser);
     return parser.tree;
 }
 
+#if MICROPY_COMP_STREAMING
+
+mp_parse_stream_t *mp_parse_stream_new(mp_lexer_t *lex) {
+    parser_t *parser = m_new_obj(parser_t);
+    parser_init(parser, lex);
+    return parser;
+}
+
+bool mp_parse_stream_next(mp_parse_stream_t *parser, mp_parse_tree_t *tree) {
+    // skip the blank lines between statements, as file_input does
+    mp_lexer_t *lex = parser->lexer;
+    while (lex->tok_kind == MP_TOKEN_NEWLINE) {
+        mp_lexer_to_next(lex);
+    }
+    if (lex->tok_kind == MP_TOKEN_END) {
+        return false;
+    }
+    parse_rule(parser, RULE_stmt, MP_PARSE_FILE_INPUT);
+    *tree = parser->tree;
+    return true;
+}
+
+void mp_parse_stream_free(mp_parse_stream_t *parser) {
+    parser_free(parser);
+    m_del_obj(parser_t, parser);
+}
+
+#endif
+
 void mp_parse_tree_clear(mp_parse_tree_t *tree) {
     mp_parse_chunk_t *chunk = tree->chunk;
     while (chunk != NULL) {
@@ -104,4 +104,14 @@ typedef struct _mp_parse_t {
 mp_parse_tree_t mp_parse(struct _mp_lexer_t *lex, mp_parse_input_kind_t input_kind);
 void mp_parse_tree_clear(mp_parse_tree_t *tree);
 
+#if MICROPY_COMP_STREAMING
+// parse file input one top-level statement at a time
+// mp_parse_stream_next returns false at the end of the input
+// mp_parse_stream_free frees the lexer along with the stream
+typedef struct _parser_t mp_parse_stream_t;
+mp_parse_stream_t *mp_parse_stream_new(struct _mp_lexer_t *lex);
+bool mp_parse_stream_next(mp_parse_stream_t *ps, mp_parse_tree_t *tree);
+void mp_parse_stream_free(mp_parse_stream_t *ps);
+#endif
+
 #endif // MICROPY_INCLUDED_PY_PARSE_H
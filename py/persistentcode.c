@@ -41,7 +41,7 @@
 #include "py/smallint.h"
 
 // The current version of .mpy files
-#define MPY_VERSION (3)
+#define MPY_VERSION (5)
 
 // The feature flags byte encodes the compile-time config options that
 // affect the generate bytecode.
@@ -102,6 +102,58 @@ STATIC void extract_prelude(const byte **ip, const byte **ip2, bytecode_prelude_
 
 #include "py/parsenum.h"
 
+#if MICROPY_PERSISTENT_CODE_XIP
+
+// State of loading a .mpy file in place.  The saver stores each distinct qstr
+// of a module as its index in order of first use, so the loader can check the
+// indices as it goes and build the table that maps them back to qstrs.
+typedef struct _xip_load_t {
+    const byte *cur;
+    const byte *end;
+    bool ok;
+    size_t n_qstr;
+    size_t alloc_qstr;
+    uint16_t *qstr_table;
+    size_t n_rc;
+    size_t alloc_rc;
+    mp_raw_code_t **rcs;
+} xip_load_t;
+
+STATIC mp_uint_t xip_readbyte(void *data) {
+    xip_load_t *xip = (xip_load_t*)data;
+    if (xip->cur < xip->end) {
+        return *xip->cur++;
+    } else {
+        return MP_READER_EOF;
+    }
+}
+
+STATIC void xip_close(void *data) {
+    (void)data;
+}
+
+// Check that the qstr operand at ip refers to qst in the module table
+STATIC void xip_link_qstr(xip_load_t *xip, const byte *ip, qstr qst) {
+    size_t idx = ip[0] | (ip[1] << 8);
+    if (!xip->ok) {
+        return;
+    }
+    if (idx < xip->n_qstr) {
+        xip->ok = xip->qstr_table[idx] == qst;
+    } else if (idx == xip->n_qstr) {
+        if (xip->n_qstr == xip->alloc_qstr) {
+            xip->qstr_table = m_renew(uint16_t, xip->qstr_table, xip->alloc_qstr, xip->alloc_qstr * 2);
+            xip->alloc_qstr *= 2;
+        }
+        xip->qstr_table[xip->n_qstr++] = qst;
+    } else {
+        // not saved with module-local indices
+        xip->ok = false;
+    }
+}
+
+#endif
+
 STATIC void raise_corrupt_mpy(void) {
     mp_raise_RuntimeError(translate("Corrupt .mpy file"));
 }
@@ -168,24 +220,58 @@ STATIC mp_obj_t load_obj(mp_reader_t *reader) {
     return MP_OBJ_FROM_PTR(&mp_const_none_obj);
 }
 
-STATIC void load_bytecode_qstrs(mp_reader_t *reader, byte *ip, byte *ip_top) {
+#if MICROPY_PERSISTENT_CODE_XIP
+#define LOAD_XIP_ARG , xip_load_t *xip
+#define LOAD_XIP_ARG_PASS , xip
+#define LOAD_XIP_ARG_PASS_NULL , NULL
+#else
+#define LOAD_XIP_ARG
+#define LOAD_XIP_ARG_PASS
+#define LOAD_XIP_ARG_PASS_NULL
+#endif
+
+// Link qst into the qstr operand at ip, or into the module table if the
+// bytecode is executed in place.
+STATIC void link_qstr(byte *ip, qstr qst LOAD_XIP_ARG) {
+    #if MICROPY_PERSISTENT_CODE_XIP
+    if (xip != NULL) {
+        xip_link_qstr(xip, ip, qst);
+        return;
+    }
+    #endif
+    ip[0] = qst;
+    ip[1] = qst >> 8;
+}
+
+STATIC void load_bytecode_qstrs(mp_reader_t *reader, byte *ip, byte *ip_top LOAD_XIP_ARG) {
     while (ip < ip_top) {
         size_t sz;
         uint f = mp_opcode_format(ip, &sz);
         if (f == MP_OPCODE_QSTR) {
-            qstr qst = load_qstr(reader);
-            ip[1] = qst;
-            ip[2] = qst >> 8;
+            link_qstr(ip + 1, load_qstr(reader) LOAD_XIP_ARG_PASS);
         }
         ip += sz;
     }
 }
 
-STATIC mp_raw_code_t *load_raw_code(mp_reader_t *reader) {
+STATIC mp_raw_code_t *load_raw_code(mp_reader_t *reader LOAD_XIP_ARG) {
     // load bytecode
     size_t bc_len = read_uint(reader);
-    byte *bytecode = m_new(byte, bc_len);
-    read_bytes(reader, bytecode, bc_len);
+    byte *bytecode;
+    #if MICROPY_PERSISTENT_CODE_XIP
+    if (xip != NULL) {
+        // the bytecode stays where it is
+        if (bc_len > (size_t)(xip->end - xip->cur)) {
+            raise_corrupt_mpy();
+        }
+        bytecode = (byte*)xip->cur;
+        xip->cur += bc_len;
+    } else
+    #endif
+    {
+        bytecode = m_new(byte, bc_len);
+        read_bytes(reader, bytecode, bc_len);
+    }
 
     // extract prelude
     const byte *ip = bytecode;
@@ -196,9 +282,9 @@ STATIC mp_raw_code_t *load_raw_code(mp_reader_t *reader) {
     // load qstrs and link global qstr ids into bytecode
     qstr simple_name = load_qstr(reader);
     qstr source_file = load_qstr(reader);
-    ((byte*)ip2)[0] = simple_name; ((byte*)ip2)[1] = simple_name >> 8;
-    ((byte*)ip2)[2] = source_file; ((byte*)ip2)[3] = source_file >> 8;
-    load_bytecode_qstrs(reader, (byte*)ip, bytecode + bc_len);
+    link_qstr((byte*)ip2, simple_name LOAD_XIP_ARG_PASS);
+    link_qstr((byte*)ip2 + 2, source_file LOAD_XIP_ARG_PASS);
+    load_bytecode_qstrs(reader, (byte*)ip, bytecode + bc_len LOAD_XIP_ARG_PASS);
 
     // load constant table
     size_t n_obj = read_uint(reader);
@@ -212,7 +298,7 @@ STATIC mp_raw_code_t *load_raw_code(mp_reader_t *reader) {
         *ct++ = (mp_uint_t)load_obj(reader);
     }
     for (size_t i = 0; i < n_raw_code; ++i) {
-        *ct++ = (mp_uint_t)(uintptr_t)load_raw_code(reader);
+        *ct++ = (mp_uint_t)(uintptr_t)load_raw_code(reader LOAD_XIP_ARG_PASS);
     }
 
     // create raw_code and return it
@@ -226,10 +312,22 @@ STATIC mp_raw_code_t *load_raw_code(mp_reader_t *reader) {
         n_obj, n_raw_code,
         #endif
         prelude.scope_flags);
+
+    #if MICROPY_PERSISTENT_CODE_XIP
+    if (xip != NULL) {
+        // the qstr table is only complete once the whole module is loaded
+        if (xip->n_rc == xip->alloc_rc) {
+            xip->rcs = m_renew(mp_raw_code_t*, xip->rcs, xip->alloc_rc, xip->alloc_rc * 2);
+            xip->alloc_rc *= 2;
+        }
+        xip->rcs[xip->n_rc++] = rc;
+    }
+    #endif
+
     return rc;
 }
 
-mp_raw_code_t *mp_raw_code_load(mp_reader_t *reader) {
+STATIC void load_header(mp_reader_t *reader) {
     byte header[4];
     read_bytes(reader, header, sizeof(header));
     if (header[0] != 'M'
@@ -238,7 +336,11 @@ mp_raw_code_t *mp_raw_code_load(mp_reader_t *reader) {
         || header[3] > mp_small_int_bits()) {
         mp_raise_MpyError(translate("Incompatible .mpy file. Please update all .mpy files. See http://adafru.it/mpy-update for more info."));
     }
-    mp_raw_code_t *rc = load_raw_code(reader);
+}
+
+mp_raw_code_t *mp_raw_code_load(mp_reader_t *reader) {
+    load_header(reader);
+    mp_raw_code_t *rc = load_raw_code(reader LOAD_XIP_ARG_PASS_NULL);
     reader->close(reader->data);
     return rc;
 }
@@ -249,7 +351,35 @@ mp_raw_code_t *mp_raw_code_load_mem(const byte *buf, size_t len) {
     return mp_raw_code_load(&reader);
 }
 
+#if MICROPY_PERSISTENT_CODE_XIP
+mp_raw_code_t *mp_raw_code_load_xip(const byte *buf, size_t len) {
+    xip_load_t xip = {buf, buf + len, true, 0, 8, m_new(uint16_t, 8), 0, 8, m_new(mp_raw_code_t*, 8)};
+    mp_reader_t reader = {&xip, xip_readbyte, xip_close, NULL};
+    load_header(&reader);
+    mp_raw_code_t *rc = load_raw_code(&reader, &xip);
+    if (xip.ok) {
+        const uint16_t *qstr_table = m_renew(uint16_t, xip.qstr_table, xip.alloc_qstr, xip.n_qstr);
+        for (size_t i = 0; i < xip.n_rc; ++i) {
+            xip.rcs[i]->data.u_byte.qstr_table = qstr_table;
+        }
+    } else {
+        // the qstr operands are not module-local indices, so load a copy
+        m_del(uint16_t, xip.qstr_table, xip.alloc_qstr);
+        rc = mp_raw_code_load_mem(buf, len);
+    }
+    m_del(mp_raw_code_t*, xip.rcs, xip.alloc_rc);
+    return rc;
+}
+#endif
+
 mp_raw_code_t *mp_raw_code_load_file(const char *filename) {
+    #if MICROPY_PERSISTENT_CODE_XIP
+    size_t len;
+    const byte *buf = mp_reader_map_file(filename, &len);
+    if (buf != NULL) {
+        return mp_raw_code_load_xip(buf, len);
+    }
+    #endif
     mp_reader_t reader;
     mp_reader_new_file(&reader, filename);
     return mp_raw_code_load(&reader);
@@ -337,21 +467,48 @@ STATIC void save_bytecode_qstrs(mp_print_t *print, const byte *ip, const byte *i
     }
 }
 
-STATIC void save_raw_code(mp_print_t *print, mp_raw_code_t *rc) {
+// The qstr operands of saved bytecode hold the index of their qstr in the
+// module, numbered in order of first use, so that the bytecode can run in
+// place (see MICROPY_PERSISTENT_CODE_XIP).  Loading a copy overwrites them.
+STATIC void index_qstr(mp_map_t *qstr_index, byte *ip) {
+    qstr qst = ip[0] | (ip[1] << 8);
+    mp_map_elem_t *elem = mp_map_lookup(qstr_index, MP_OBJ_NEW_QSTR(qst), MP_MAP_LOOKUP_ADD_IF_NOT_FOUND);
+    if (elem->value == MP_OBJ_NULL) {
+        elem->value = MP_OBJ_NEW_SMALL_INT(qstr_index->used - 1);
+    }
+    mp_uint_t idx = MP_OBJ_SMALL_INT_VALUE(elem->value);
+    ip[0] = idx;
+    ip[1] = idx >> 8;
+}
+
+STATIC void save_raw_code(mp_print_t *print, mp_raw_code_t *rc, mp_map_t *qstr_index) {
     if (rc->kind != MP_CODE_BYTECODE) {
         mp_raise_ValueError(translate("can only save bytecode"));
     }
 
-    // save bytecode
-    mp_print_uint(print, rc->data.u_byte.bc_len);
-    mp_print_bytes(print, rc->data.u_byte.bytecode, rc->data.u_byte.bc_len);
-
     // extract prelude
     const byte *ip = rc->data.u_byte.bytecode;
     const byte *ip2;
     bytecode_prelude_t prelude;
     extract_prelude(&ip, &ip2, &prelude);
 
+    // save bytecode, with qstrs replaced by their index
+    size_t bc_len = rc->data.u_byte.bc_len;
+    byte *bc = m_new(byte, bc_len);
+    memcpy(bc, rc->data.u_byte.bytecode, bc_len);
+    index_qstr(qstr_index, bc + (ip2 - rc->data.u_byte.bytecode));
+    index_qstr(qstr_index, bc + (ip2 - rc->data.u_byte.bytecode) + 2);
+    for (byte *bc_ip = bc + (ip - rc->data.u_byte.bytecode); bc_ip < bc + bc_len;) {
+        size_t sz;
+        if (mp_opcode_format(bc_ip, &sz) == MP_OPCODE_QSTR) {
+            index_qstr(qstr_index, bc_ip + 1);
+        }
+        bc_ip += sz;
+    }
+    mp_print_uint(print, bc_len);
+    mp_print_bytes(print, bc, bc_len);
+    m_del(byte, bc, bc_len);
+
     // save qstrs
     save_qstr(print, ip2[0] | (ip2[1] << 8)); // simple_name
     save_qstr(print, ip2[2] | (ip2[3] << 8)); // source_file
@@ -369,7 +526,7 @@ STATIC void save_raw_code(mp_print_t *print, mp_raw_code_t *rc) {
         save_obj(print, (mp_obj_t)*const_table++);
     }
     for (uint i = 0; i < rc->data.u_byte.n_raw_code; ++i) {
-        save_raw_code(print, (mp_raw_code_t*)(uintptr_t)*const_table++);
+        save_raw_code(print, (mp_raw_code_t*)(uintptr_t)*const_table++, qstr_index);
     }
 }
 
@@ -388,7 +545,10 @@ void mp_raw_code_save(mp_raw_code_t *rc, mp_print_t *print) {
     };
     mp_print_bytes(print, header, sizeof(header));
 
-    save_raw_code(print, rc);
+    mp_map_t qstr_index;
+    mp_map_init(&qstr_index, 0);
+    save_raw_code(print, rc, &qstr_index);
+    mp_map_deinit(&qstr_index);
 }
 
 // here we define mp_raw_code_save_file depending on the port
@@ -413,6 +573,19 @@ void mp_raw_code_save_file(mp_raw_code_t *rc, const char *filename) {
     close(fd);
 }
 
+#elif MICROPY_VFS
+
+#include "py/stream.h"
+#include "extmod/vfs.h"
+
+void mp_raw_code_save_file(mp_raw_code_t *rc, const char *filename) {
+    mp_obj_t args[2] = {mp_obj_new_str(filename, strlen(filename)), MP_OBJ_NEW_QSTR(MP_QSTR_wb)};
+    mp_obj_t file = mp_vfs_open(2, args, (mp_map_t*)&mp_const_empty_map);
+    mp_print_t file_print = {MP_OBJ_TO_PTR(file), mp_stream_write_adaptor};
+    mp_raw_code_save(rc, &file_print);
+    mp_stream_close(file);
+}
+
 #else
 #error mp_raw_code_save_file not implemented for this platform
 #endif
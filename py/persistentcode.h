@@ -33,6 +33,8 @@
 mp_raw_code_t *mp_raw_code_load(mp_reader_t *reader);
 mp_raw_code_t *mp_raw_code_load_mem(const byte *buf, size_t len);
 mp_raw_code_t *mp_raw_code_load_file(const char *filename);
+// The bytecode runs from buf, which must not change while the code is alive
+mp_raw_code_t *mp_raw_code_load_xip(const byte *buf, size_t len);
 
 void mp_raw_code_save(mp_raw_code_t *rc, mp_print_t *print);
 void mp_raw_code_save_file(mp_raw_code_t *rc, const char *filename);
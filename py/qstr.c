@@ -105,13 +105,58 @@ const qstr_pool_t mp_qstr_const_pool = {
 #ifndef NO_QSTR
 #define QDEF(id, str) str,
 #define TRANSLATION(id, length, compressed...)
+#define QHASH_BUCKET(start)
+#define QHASH_ENTRY(id)
 #include "genhdr/qstrdefs.generated.h"
+#undef QHASH_ENTRY
+#undef QHASH_BUCKET
 #undef TRANSLATION
 #undef QDEF
 #endif
     },
 };
 
+#if MICROPY_QSTR_HASH_INDEX
+
+// Index of the ROM pool generated by makeqstrdata.py: the qstrs in
+// bucket i are qstr_const_hash_entries[buckets[i]] up to buckets[i + 1].
+STATIC const uint16_t qstr_const_hash_buckets[] = {
+#ifndef NO_QSTR
+#define QDEF(id, str)
+#define TRANSLATION(id, length, compressed...)
+#define QHASH_BUCKET(start) start,
+#define QHASH_ENTRY(id)
+#include "genhdr/qstrdefs.generated.h"
+#undef QHASH_ENTRY
+#undef QHASH_BUCKET
+#undef TRANSLATION
+#undef QDEF
+#endif
+};
+
+STATIC const uint16_t qstr_const_hash_entries[] = {
+#ifndef NO_QSTR
+#define QDEF(id, str)
+#define TRANSLATION(id, length, compressed...)
+#define QHASH_BUCKET(start)
+#define QHASH_ENTRY(id) id,
+#include "genhdr/qstrdefs.generated.h"
+#undef QHASH_ENTRY
+#undef QHASH_BUCKET
+#undef TRANSLATION
+#undef QDEF
+#endif
+};
+
+// this must match compute_index_hash in makeqstrdata.py
+// The length is folded in above the hash so that ports with 1-byte hashes
+// still spread their qstrs over indexes with more than 256 slots.
+STATIC inline mp_uint_t qstr_index_hash(mp_uint_t hash, size_t len) {
+    return hash ^ (len << (8 * MICROPY_QSTR_BYTES_IN_HASH));
+}
+
+#endif
+
 #ifdef MICROPY_QSTR_EXTRA_POOL
 extern const qstr_pool_t MICROPY_QSTR_EXTRA_POOL;
 #define CONST_POOL MICROPY_QSTR_EXTRA_POOL
@@ -122,6 +167,10 @@ extern const qstr_pool_t MICROPY_QSTR_EXTRA_POOL;
 void qstr_init(void) {
     MP_STATE_VM(last_pool) = (qstr_pool_t*)&CONST_POOL; // we won't modify the const_pool since it has no allocated room left
     MP_STATE_VM(qstr_last_chunk) = NULL;
+    #if MICROPY_QSTR_HASH_INDEX
+    MP_STATE_VM(qstr_hash_table) = NULL;
+    MP_STATE_VM(qstr_hash_alloc) = 0;
+    #endif
 
     #if MICROPY_PY_THREAD
     mp_thread_mutex_init(&MP_STATE_VM(qstr_mutex));
@@ -138,6 +187,97 @@ STATIC const byte *find_qstr(qstr q) {
     return pool->qstrs[q - pool->total_prev_len];
 }
 
+#if MICROPY_QSTR_HASH_INDEX
+STATIC qstr qstr_find_const(mp_uint_t str_hash, const char *str, size_t str_len) {
+    size_t n_buckets = MP_ARRAY_SIZE(qstr_const_hash_buckets) - 1;
+    size_t bucket = qstr_index_hash(str_hash, str_len) & (n_buckets - 1);
+    for (size_t i = qstr_const_hash_buckets[bucket]; i < qstr_const_hash_buckets[bucket + 1]; i++) {
+        qstr q = qstr_const_hash_entries[i];
+        const byte *qd = mp_qstr_const_pool.qstrs[q];
+        if (Q_GET_HASH(qd) == str_hash && Q_GET_LENGTH(qd) == str_len && memcmp(Q_GET_DATA(qd), str, str_len) == 0) {
+            return q;
+        }
+    }
+    return 0;
+}
+
+// Each slot of the hash table holds a qstr id in its low 16 bits and the hash
+// of that qstr above them, so most probes can be rejected without having to
+// walk the pools to find the qstr data.
+#define QSTR_HASH_SLOT(q, hash) ((uint32_t)(q) | ((uint32_t)(hash) << 16))
+#define QSTR_HASH_SLOT_QSTR(slot) ((slot) & 0xffff)
+#define QSTR_HASH_SLOT_HASH(slot) ((slot) >> 16)
+
+// The table is never more than two thirds full so there is always an empty
+// slot to stop the search.
+STATIC qstr qstr_hash_table_lookup(mp_uint_t str_hash, const char *str, size_t str_len) {
+    size_t mask = MP_STATE_VM(qstr_hash_alloc) - 1;
+    for (size_t i = qstr_index_hash(str_hash, str_len) & mask;; i = (i + 1) & mask) {
+        uint32_t slot = MP_STATE_VM(qstr_hash_table)[i];
+        if (slot == 0) {
+            return 0;
+        }
+        if (QSTR_HASH_SLOT_HASH(slot) == str_hash) {
+            qstr q = QSTR_HASH_SLOT_QSTR(slot);
+            const byte *qd = find_qstr(q);
+            if (Q_GET_LENGTH(qd) == str_len && memcmp(Q_GET_DATA(qd), str, str_len) == 0) {
+                return q;
+            }
+        }
+    }
+}
+
+// The qstr must not be in the table already.
+STATIC void qstr_hash_table_insert(const byte *q_ptr, qstr q) {
+    size_t mask = MP_STATE_VM(qstr_hash_alloc) - 1;
+    size_t i = qstr_index_hash(Q_GET_HASH(q_ptr), Q_GET_LENGTH(q_ptr)) & mask;
+    while (MP_STATE_VM(qstr_hash_table)[i] != 0) {
+        i = (i + 1) & mask;
+    }
+    MP_STATE_VM(qstr_hash_table)[i] = QSTR_HASH_SLOT(q, Q_GET_HASH(q_ptr));
+}
+
+// Make sure the hash table has room for n_qstr entries, rebuilding it from
+// the pools above the ROM pool if it has to grow.  The table is only a cache:
+// if there is no memory for it, or the qstr ids no longer fit in 16 bits,
+// then it is dropped and the pools are scanned instead.
+// qstr_mutex must be taken while in this function
+STATIC void qstr_hash_table_reserve(size_t n_qstr) {
+    size_t alloc = MP_STATE_VM(qstr_hash_alloc);
+    bool fits = MP_QSTRnumber_of + n_qstr <= 0x10000;
+    if (fits && 2 * alloc >= 3 * n_qstr) {
+        return;
+    }
+    // qstr_find_strn does not take the mutex, so when threads run without the
+    // GIL the old table is left for the GC as another thread may be reading it
+    #if !(MICROPY_PY_THREAD && !MICROPY_PY_THREAD_GIL)
+    m_del(uint32_t, MP_STATE_VM(qstr_hash_table), alloc);
+    #endif
+    MP_STATE_VM(qstr_hash_table) = NULL;
+    MP_STATE_VM(qstr_hash_alloc) = 0;
+    if (!fits) {
+        return;
+    }
+    if (alloc == 0) {
+        alloc = 32;
+    }
+    while (2 * alloc < 3 * n_qstr) {
+        alloc *= 2;
+    }
+    MP_STATE_VM(qstr_hash_table) = m_new_ll_maybe(uint32_t, alloc);
+    if (MP_STATE_VM(qstr_hash_table) == NULL) {
+        return;
+    }
+    memset(MP_STATE_VM(qstr_hash_table), 0, alloc * sizeof(uint32_t));
+    MP_STATE_VM(qstr_hash_alloc) = alloc;
+    for (qstr_pool_t *pool = MP_STATE_VM(last_pool); pool != &mp_qstr_const_pool; pool = pool->prev) {
+        for (size_t i = 0; i < pool->len; i++) {
+            qstr_hash_table_insert(pool->qstrs[i], pool->total_prev_len + i);
+        }
+    }
+}
+#endif
+
 // qstr_mutex must be taken while in this function
 STATIC qstr qstr_add(const byte *q_ptr) {
     DEBUG_printf("QSTR: add hash=%d len=%d data=%.*s\n", Q_GET_HASH(q_ptr), Q_GET_LENGTH(q_ptr), Q_GET_LENGTH(q_ptr), Q_GET_DATA(q_ptr));
@@ -159,21 +299,44 @@ STATIC qstr qstr_add(const byte *q_ptr) {
         pool->len = 0;
         MP_STATE_VM(last_pool) = pool;
         DEBUG_printf("QSTR: allocate new pool of size %d\n", MP_STATE_VM(last_pool)->alloc);
+        #if MICROPY_QSTR_HASH_INDEX
+        qstr_hash_table_reserve(QSTR_TOTAL() - MP_QSTRnumber_of + new_pool_length);
+        #endif
     }
 
     // add the new qstr
     MP_STATE_VM(last_pool)->qstrs[MP_STATE_VM(last_pool)->len++] = q_ptr;
+    qstr q = MP_STATE_VM(last_pool)->total_prev_len + MP_STATE_VM(last_pool)->len - 1;
+    #if MICROPY_QSTR_HASH_INDEX
+    if (MP_STATE_VM(qstr_hash_table) != NULL) {
+        qstr_hash_table_insert(q_ptr, q);
+    }
+    #endif
 
     // return id for the newly-added qstr
-    return MP_STATE_VM(last_pool)->total_prev_len + MP_STATE_VM(last_pool)->len - 1;
+    return q;
 }
 
 qstr qstr_find_strn(const char *str, size_t str_len) {
     // work out hash of str
     mp_uint_t str_hash = qstr_compute_hash((const byte*)str, str_len);
 
+    #if MICROPY_QSTR_HASH_INDEX
+    qstr found = qstr_find_const(str_hash, str, str_len);
+    if (found != 0) {
+        return found;
+    }
+    if (MP_STATE_VM(qstr_hash_table) != NULL) {
+        return qstr_hash_table_lookup(str_hash, str, str_len);
+    }
+    // no hash table, so scan the pools above the ROM pool
+    qstr_pool_t *pool_end = (qstr_pool_t*)&mp_qstr_const_pool;
+    #else
+    qstr_pool_t *pool_end = NULL;
+    #endif
+
     // search pools for the data
-    for (qstr_pool_t *pool = MP_STATE_VM(last_pool); pool != NULL; pool = pool->prev) {
+    for (qstr_pool_t *pool = MP_STATE_VM(last_pool); pool != pool_end; pool = pool->prev) {
         for (const byte **q = pool->qstrs, **q_top = pool->qstrs + pool->len; q < q_top; q++) {
             if (Q_GET_HASH(*q) == str_hash && Q_GET_LENGTH(*q) == str_len && memcmp(Q_GET_DATA(*q), str, str_len) == 0) {
                 return pool->total_prev_len + (q - pool->qstrs);
@@ -286,6 +449,9 @@ void qstr_pool_info(size_t *n_pool, size_t *n_qstr, size_t *n_str_data_bytes, si
         *n_total_bytes += sizeof(qstr_pool_t) + sizeof(qstr) * pool->alloc;
         #endif
     }
+    #if MICROPY_QSTR_HASH_INDEX
+    *n_total_bytes += sizeof(uint32_t) * MP_STATE_VM(qstr_hash_alloc);
+    #endif
     *n_total_bytes += *n_str_data_bytes;
     QSTR_EXIT();
 }
@@ -47,6 +47,18 @@ STATIC mp_uint_t mp_reader_mem_readbyte(void *data) {
     }
 }
 
+STATIC const byte *mp_reader_mem_readbuf(void *data, size_t *len) {
+    mp_reader_mem_t *reader = (mp_reader_mem_t*)data;
+    if (reader->cur < reader->end) {
+        const byte *buf = reader->cur;
+        *len = reader->end - buf;
+        reader->cur = reader->end;
+        return buf;
+    } else {
+        return NULL;
+    }
+}
+
 STATIC void mp_reader_mem_close(void *data) {
     mp_reader_mem_t *reader = (mp_reader_mem_t*)data;
     if (reader->free_len > 0) {
@@ -64,6 +76,7 @@ void mp_reader_new_mem(mp_reader_t *reader, const byte *buf, size_t len, size_t
     reader->data = rm;
     reader->readbyte = mp_reader_mem_readbyte;
     reader->close = mp_reader_mem_close;
+    reader->readbuf = mp_reader_mem_readbuf;
 }
 
 #if MICROPY_READER_POSIX
@@ -77,27 +90,46 @@ typedef struct _mp_reader_posix_t {
     int fd;
     size_t len;
     size_t pos;
-    byte buf[20];
+    byte buf[MICROPY_READER_BUF_SIZE];
 } mp_reader_posix_t;
 
-STATIC mp_uint_t mp_reader_posix_readbyte(void *data) {
-    mp_reader_posix_t *reader = (mp_reader_posix_t*)data;
+// Refill the buffer if it's all been read, and return false at end of stream
+STATIC bool mp_reader_posix_fill(mp_reader_posix_t *reader) {
     if (reader->pos >= reader->len) {
         if (reader->len == 0) {
-            return MP_READER_EOF;
+            return false;
         } else {
             int n = read(reader->fd, reader->buf, sizeof(reader->buf));
             if (n <= 0) {
                 reader->len = 0;
-                return MP_READER_EOF;
+                return false;
             }
             reader->len = n;
             reader->pos = 0;
         }
     }
+    return true;
+}
+
+STATIC mp_uint_t mp_reader_posix_readbyte(void *data) {
+    mp_reader_posix_t *reader = (mp_reader_posix_t*)data;
+    if (!mp_reader_posix_fill(reader)) {
+        return MP_READER_EOF;
+    }
     return reader->buf[reader->pos++];
 }
 
+STATIC const byte *mp_reader_posix_readbuf(void *data, size_t *len) {
+    mp_reader_posix_t *reader = (mp_reader_posix_t*)data;
+    if (!mp_reader_posix_fill(reader)) {
+        return NULL;
+    }
+    const byte *buf = reader->buf + reader->pos;
+    *len = reader->len - reader->pos;
+    reader->pos = reader->len;
+    return buf;
+}
+
 STATIC void mp_reader_posix_close(void *data) {
     mp_reader_posix_t *reader = (mp_reader_posix_t*)data;
     if (reader->close_fd) {
@@ -122,6 +154,7 @@ void mp_reader_new_file_from_fd(mp_reader_t *reader, int fd, bool close_fd) {
     reader->data = rp;
     reader->readbyte = mp_reader_posix_readbyte;
     reader->close = mp_reader_posix_close;
+    reader->readbuf = mp_reader_posix_readbuf;
 }
 
 #if !MICROPY_VFS_POSIX
@@ -133,6 +166,31 @@ void mp_reader_new_file(mp_reader_t *reader, const char *filename) {
     }
     mp_reader_new_file_from_fd(reader, fd, true);
 }
+
+#if MICROPY_PERSISTENT_CODE_XIP
+
+#include <sys/mman.h>
+
+const byte *mp_reader_map_file(const char *filename, size_t *len) {
+    int fd = open(filename, O_RDONLY);
+    if (fd < 0) {
+        return NULL;
+    }
+    struct stat st;
+    void *buf = MAP_FAILED;
+    if (fstat(fd, &st) == 0 && S_ISREG(st.st_mode) && st.st_size > 0) {
+        // the mapping is never removed, the code may run until the end
+        buf = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    }
+    close(fd);
+    if (buf == MAP_FAILED) {
+        return NULL;
+    }
+    *len = st.st_size;
+    return buf;
+}
+
+#endif
 #endif
 
 #endif
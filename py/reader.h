@@ -33,14 +33,22 @@
 // it can be called again after returning MP_READER_EOF, and in that case must return MP_READER_EOF
 #define MP_READER_EOF ((mp_uint_t)(-1))
 
+// the optional readbuf function returns the rest of the buffered input, which
+// then counts as read, and stores its length, which is never 0, in len
+// it must return NULL if end of stream; the bytes are valid until the next read
 typedef struct _mp_reader_t {
     void *data;
     mp_uint_t (*readbyte)(void *data);
     void (*close)(void *data);
+    const byte *(*readbuf)(void *data, size_t *len);
 } mp_reader_t;
 
 void mp_reader_new_mem(mp_reader_t *reader, const byte *buf, size_t len, size_t free_len);
 void mp_reader_new_file(mp_reader_t *reader, const char *filename);
 void mp_reader_new_file_from_fd(mp_reader_t *reader, int fd, bool close_fd);
 
+// Map a file read-only into memory for as long as the program runs, or return
+// NULL if it can't be mapped.  Used by MICROPY_PERSISTENT_CODE_XIP.
+const byte *mp_reader_map_file(const char *filename, size_t *len);
+
 #endif // MICROPY_INCLUDED_PY_READER_H
@@ -100,6 +100,15 @@ void mp_init(void) {
     MP_STATE_VM(mp_optimise_value) = 0;
     #endif
 
+    #if MICROPY_OPT_TYPE_ATTR_CACHE
+    mp_obj_type_attr_cache_clear();
+    #endif
+
+    #if MICROPY_OPT_LOAD_GLOBAL_CACHE
+    memset(MP_STATE_VM(load_global_cache), 0, sizeof(MP_STATE_VM(load_global_cache)));
+    MP_STATE_VM(load_global_cache_version) = 0;
+    #endif
+
     // init global module dict
     mp_obj_dict_init(&MP_STATE_VM(mp_loaded_modules_dict), 3);
 
@@ -116,6 +125,10 @@ void mp_init(void) {
     MP_STATE_VM(mp_module_builtins_override_dict) = NULL;
     #endif
 
+    #if MICROPY_READER_VFS
+    MP_STATE_VM(reader_vfs_spare) = NULL;
+    #endif
+
     #if MICROPY_PY_OS_DUPTERM
     for (size_t i = 0; i < MICROPY_PY_OS_DUPTERM; ++i) {
         MP_STATE_VM(dupterm_objs[i]) = MP_OBJ_NULL;
@@ -159,7 +172,7 @@ mp_obj_t mp_load_name(qstr qst) {
     return mp_load_global(qst);
 }
 
-mp_obj_t mp_load_global(qstr qst) {
+STATIC mp_map_elem_t *mp_load_global_elem(qstr qst) {
     // logic: search globals, builtins
     DEBUG_OP_printf("load global %s\n", qstr_str(qst));
     mp_map_elem_t *elem = mp_map_lookup(&mp_globals_get()->map, MP_OBJ_NEW_QSTR(qst), MP_MAP_LOOKUP);
@@ -169,7 +182,7 @@ mp_obj_t mp_load_global(qstr qst) {
             // lookup in additional dynamic table of builtins first
             elem = mp_map_lookup(&MP_STATE_VM(mp_module_builtins_override_dict)->map, MP_OBJ_NEW_QSTR(qst), MP_MAP_LOOKUP);
             if (elem != NULL) {
-                return elem->value;
+                return elem;
             }
         }
         #endif
@@ -183,8 +196,38 @@ mp_obj_t mp_load_global(qstr qst) {
             }
         }
     }
+    return elem;
+}
+
+mp_obj_t mp_load_global(qstr qst) {
+    return mp_load_global_elem(qst)->value;
+}
+
+#if MICROPY_OPT_LOAD_GLOBAL_CACHE
+// Load a global for the bytecode at site, within the bytecode starting at code,
+// remembering where it was found.  An entry stays valid until a watched map
+// gains or loses a key, which covers the globals dict the name was looked up
+// in and the builtins override dict.
+mp_obj_t mp_load_global_cached(qstr qst, const byte *code, const byte *site) {
+    mp_obj_dict_t *globals = mp_globals_get();
+    uintptr_t i = (uintptr_t)site ^ ((uintptr_t)site >> 8);
+    mp_load_global_cache_entry_t *entry = &MP_STATE_VM(load_global_cache)[i & (MICROPY_OPT_LOAD_GLOBAL_CACHE_SIZE - 1)];
+    if (entry->site == site && entry->code == code && entry->globals == globals
+        && entry->version == MP_STATE_VM(load_global_cache_version)) {
+        return entry->elem->value;
+    }
+    mp_map_elem_t *elem = mp_load_global_elem(qst);
+    if (!globals->map.is_fixed) {
+        globals->map.is_watched = 1;
+        entry->code = code;
+        entry->site = site;
+        entry->globals = globals;
+        entry->elem = elem;
+        entry->version = MP_STATE_VM(load_global_cache_version);
+    }
     return elem->value;
 }
+#endif
 
 mp_obj_t mp_load_build_class(void) {
     DEBUG_OP_printf("load_build_class\n");
@@ -1077,11 +1120,18 @@ void mp_load_method_maybe(mp_obj_t obj, qstr attr, mp_obj_t *dest) {
         // generic method lookup
         // this is a lookup in the object (ie not class or type)
         assert(type->locals_dict->base.type == &mp_type_dict); // MicroPython restriction, for now
+        #if MICROPY_OPT_TYPE_ATTR_CACHE
+        mp_obj_t member = mp_obj_type_locals_lookup(type, attr);
+        if (member != MP_OBJ_NULL) {
+            mp_convert_member_lookup(obj, type, member, dest);
+        }
+        #else
         mp_map_t *locals_map = &type->locals_dict->map;
         mp_map_elem_t *elem = mp_map_lookup(locals_map, MP_OBJ_NEW_QSTR(attr), MP_MAP_LOOKUP);
         if (elem != NULL) {
             mp_convert_member_lookup(obj, type, elem->value, dest);
         }
+        #endif
     }
 }
 
@@ -1140,10 +1190,15 @@ void mp_store_attr(mp_obj_t base, qstr attr, mp_obj_t value) {
         // generic method lookup
         // this is a lookup in the object (ie not class or type)
         assert(type->locals_dict->base.type == &mp_type_dict); // Micro Python restriction, for now
+        #if MICROPY_OPT_TYPE_ATTR_CACHE
+        mp_obj_t member = mp_obj_type_locals_lookup(type, attr);
+        #else
         mp_map_t *locals_map = &type->locals_dict->map;
         mp_map_elem_t *elem = mp_map_lookup(locals_map, MP_OBJ_NEW_QSTR(attr), MP_MAP_LOOKUP);
+        mp_obj_t member = elem != NULL ? elem->value : MP_OBJ_NULL;
+        #endif
         // If base is MP_OBJ_NULL, we looking at the class itself, not an instance.
-        if (elem != NULL && MP_OBJ_IS_TYPE(elem->value, &mp_type_property) && base != MP_OBJ_NULL) {
+        if (member != MP_OBJ_NULL && MP_OBJ_IS_TYPE(member, &mp_type_property) && base != MP_OBJ_NULL) {
             // attribute exists and is a property; delegate the store/delete
             // Note: This is an optimisation for code size and execution time.
             // The proper way to do it is have the functionality just below in
@@ -1151,7 +1206,7 @@ void mp_store_attr(mp_obj_t base, qstr attr, mp_obj_t value) {
             // would be called by the descriptor code down below.  But that way
             // requires overhead for the nested mp_call's and overhead for
             // the code.
-            const mp_obj_t *proxy = mp_obj_property_get(elem->value);
+            const mp_obj_t *proxy = mp_obj_property_get(member);
             mp_obj_t dest[2] = {base, value};
             if (value == MP_OBJ_NULL) {
                 // delete attribute
@@ -1499,6 +1554,44 @@ mp_obj_t mp_parse_compile_execute(mp_lexer_t *lex, mp_parse_input_kind_t parse_i
     }
 }
 
+#if MICROPY_COMP_STREAMING
+void mp_parse_compile_execute_stream(mp_lexer_t *lex, mp_obj_dict_t *globals, mp_obj_dict_t *locals) {
+    qstr source_name = lex->source_name;
+    mp_parse_stream_t *volatile ps = mp_parse_stream_new(lex);
+
+    // save context
+    mp_obj_dict_t *volatile old_globals = mp_globals_get();
+    mp_obj_dict_t *volatile old_locals = mp_locals_get();
+
+    // set new context
+    mp_globals_set(globals);
+    mp_locals_set(locals);
+
+    nlr_buf_t nlr;
+    if (nlr_push(&nlr) == 0) {
+        // parse, compile and execute one top-level statement at a time, so the
+        // parse tree and compiler state of only one statement is live at once
+        mp_parse_tree_t parse_tree;
+        while (mp_parse_stream_next(ps, &parse_tree)) {
+            mp_obj_t module_fun = mp_compile(&parse_tree, source_name, MP_EMIT_OPT_NONE, false);
+            mp_call_function_0(module_fun);
+        }
+
+        // finish nlr block, free the stream and restore context
+        nlr_pop();
+        mp_parse_stream_free(ps);
+        mp_globals_set(old_globals);
+        mp_locals_set(old_locals);
+    } else {
+        // exception; close the source, restore context and re-raise same exception
+        mp_parse_stream_free(ps);
+        mp_globals_set(old_globals);
+        mp_locals_set(old_locals);
+        nlr_jump(nlr.ret_val);
+    }
+}
+#endif
+
 #endif // MICROPY_ENABLE_COMPILER
 
 NORETURN void m_malloc_fail(size_t num_bytes) {
@@ -25,6 +25,7 @@
  */
 
 #include <assert.h>
+#include <string.h>
 
 #include "py/scope.h"
 
@@ -40,8 +41,9 @@ STATIC const uint8_t scope_simple_name_table[] = {
     [SCOPE_GEN_EXPR] = MP_QSTR__lt_genexpr_gt_,
 };
 
-scope_t *scope_new(scope_kind_t kind, mp_parse_node_t pn, qstr source_file, mp_uint_t emit_options) {
-    scope_t *scope = m_new0(scope_t, 1);
+scope_t *scope_new(m_arena_t *arena, scope_kind_t kind, mp_parse_node_t pn, qstr source_file, mp_uint_t emit_options) {
+    scope_t *scope = m_arena_new(arena, scope_t, 1);
+    scope->arena = arena;
     scope->kind = kind;
     scope->pn = pn;
     scope->source_file = source_file;
@@ -54,16 +56,11 @@ scope_t *scope_new(scope_kind_t kind, mp_parse_node_t pn, qstr source_file, mp_u
     scope->raw_code = mp_emit_glue_new_raw_code();
     scope->emit_options = emit_options;
     scope->id_info_alloc = MICROPY_ALLOC_SCOPE_ID_INIT;
-    scope->id_info = m_new(id_info_t, scope->id_info_alloc);
+    scope->id_info = m_arena_new(arena, id_info_t, scope->id_info_alloc);
 
     return scope;
 }
 
-void scope_free(scope_t *scope) {
-    m_del(id_info_t, scope->id_info, scope->id_info_alloc);
-    m_del(scope_t, scope, 1);
-}
-
 id_info_t *scope_find_or_add_id(scope_t *scope, qstr qst, bool *added) {
     id_info_t *id_info = scope_find(scope, qst);
     if (id_info != NULL) {
@@ -72,9 +69,13 @@ id_info_t *scope_find_or_add_id(scope_t *scope, qstr qst, bool *added) {
     }
 
     // make sure we have enough memory
+    // the old array stays in the arena until it's freed, so grow geometrically
     if (scope->id_info_len >= scope->id_info_alloc) {
-        scope->id_info = m_renew(id_info_t, scope->id_info, scope->id_info_alloc, scope->id_info_alloc + MICROPY_ALLOC_SCOPE_ID_INC);
-        scope->id_info_alloc += MICROPY_ALLOC_SCOPE_ID_INC;
+        size_t alloc = scope->id_info_alloc + MAX(MICROPY_ALLOC_SCOPE_ID_INC, scope->id_info_alloc / 2);
+        id_info_t *new_info = m_arena_new(scope->arena, id_info_t, alloc);
+        memcpy(new_info, scope->id_info, scope->id_info_len * sizeof(id_info_t));
+        scope->id_info = new_info;
+        scope->id_info_alloc = alloc;
     }
 
     // add new id to end of array of all ids; this seems to match CPython
@@ -85,10 +85,10 @@ typedef struct _scope_t {
     uint16_t id_info_alloc;
     uint16_t id_info_len;
     id_info_t *id_info;
+    m_arena_t *arena;        // the scope and its ids are allocated from here
 } scope_t;
 
-scope_t *scope_new(scope_kind_t kind, mp_parse_node_t pn, qstr source_file, mp_uint_t emit_options);
-void scope_free(scope_t *scope);
+scope_t *scope_new(m_arena_t *arena, scope_kind_t kind, mp_parse_node_t pn, qstr source_file, mp_uint_t emit_options);
 id_info_t *scope_find_or_add_id(scope_t *scope, qstr qstr, bool *added);
 id_info_t *scope_find(scope_t *scope, qstr qstr);
 id_info_t *scope_find_global(scope_t *scope, qstr qstr);
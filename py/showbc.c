@@ -396,11 +396,46 @@ const byte *mp_bytecode_print_str(const byte *ip) {
             printf("GET_ITER_STACK");
             break;
 
+        case MP_BC_LOAD_FAST_ATTR:
+            DECODE_QSTR;
+            printf("LOAD_FAST_ATTR %u %s", *ip++, qstr_str(qst));
+            break;
+
+        case MP_BC_LOAD_FAST_METHOD:
+            DECODE_QSTR;
+            printf("LOAD_FAST_METHOD %u %s", *ip++, qstr_str(qst));
+            break;
+
+        case MP_BC_BINARY_OP_FAST_FAST:
+            printf("BINARY_OP_FAST_FAST %u %u %u %s", ip[0], ip[1], ip[2], qstr_str(mp_binary_op_method_name[ip[2]]));
+            ip += 3;
+            break;
+
+        case MP_BC_BINARY_OP_FAST_SMALL_INT: {
+            mp_int_t num = 0;
+            if ((ip[0] & 0x40) != 0) {
+                // Number is negative
+                num--;
+            }
+            do {
+                num = (num * 128) | (*ip & 0x7f);
+            } while ((*ip++ & 0x80) != 0);
+            printf("BINARY_OP_FAST_SMALL_INT %u " INT_FMT " %u %s", ip[0], num, ip[1], qstr_str(mp_binary_op_method_name[ip[1]]));
+            ip += 2;
+            break;
+        }
+
         case MP_BC_FOR_ITER:
             DECODE_ULABEL; // the jump offset if iteration finishes; for labels are always forward
             printf("FOR_ITER " UINT_FMT, (mp_uint_t)(ip + unum - mp_showbc_code_start));
             break;
 
+        case MP_BC_FOR_ITER_UNPACK:
+            DECODE_ULABEL;
+            printf("FOR_ITER_UNPACK " UINT_FMT " %u", (mp_uint_t)(ip + unum - mp_showbc_code_start), ip[0]);
+            ip += 1;
+            break;
+
         case MP_BC_POP_BLOCK:
             // pops block and restores the stack
             printf("POP_BLOCK");
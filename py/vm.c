@@ -29,9 +29,16 @@
 #include <string.h>
 #include <assert.h>
 
+#include "py/binary.h"
 #include "py/emitglue.h"
+#include "py/objarray.h"
+#include "py/objlist.h"
+#include "py/objrange.h"
+#include "py/objstr.h"
+#include "py/objtuple.h"
 #include "py/objtype.h"
 #include "py/runtime.h"
+#include "py/smallint.h"
 #include "py/bc0.h"
 #include "py/bc.h"
 
@@ -58,9 +65,18 @@
 
 #if MICROPY_PERSISTENT_CODE
 
+#if MICROPY_PERSISTENT_CODE_XIP
 #define DECODE_QSTR \
     qstr qst = ip[0] | ip[1] << 8; \
+    if (qstr_table != NULL) { \
+        qst = qstr_table[qst]; \
+    } \
     ip += 2;
+#else
+#define DECODE_QSTR \
+    qstr qst = ip[0] | ip[1] << 8; \
+    ip += 2;
+#endif
 #define DECODE_PTR \
     DECODE_UINT; \
     void *ptr = (void*)(uintptr_t)code_state->fun_bc->const_table[unum]
@@ -68,6 +84,14 @@
     DECODE_UINT; \
     mp_obj_t obj = (mp_obj_t)code_state->fun_bc->const_table[unum]
 
+#if MICROPY_PERSISTENT_CODE_XIP
+// Bytecode run in place from a .mpy file may be read-only, so the cache bytes
+// in it are only read and new values go to a scratch byte
+#define CACHE_BYTE(ip) (*(qstr_table == NULL ? (byte*)(ip) : (cache_scratch = *(ip), &cache_scratch)))
+#else
+#define CACHE_BYTE(ip) (*(byte*)(ip))
+#endif
+
 #else
 
 #define DECODE_QSTR qstr qst = 0; \
@@ -110,6 +134,242 @@
     exc_sp--; /* pop back to previous exception handler */ \
     CLEAR_SYS_EXC_INFO() /* just clear sys.exc_info(), not compliant, but it shouldn't be used in 1st place */
 
+#if MICROPY_OPT_QUICKEN
+
+// Only bytecode in the GC heap is rewritten, frozen bytecode may be in ROM
+#define QUICKEN(opcode_ptr, opcode) do { \
+    if ((const byte*)(opcode_ptr) >= MP_STATE_MEM(gc_pool_start) \
+        && (const byte*)(opcode_ptr) < MP_STATE_MEM(gc_pool_end)) { \
+        *(byte*)(opcode_ptr) = (opcode); \
+    } \
+} while (0)
+
+// Specialised opcode for BINARY_OP_MULTI + op when both arguments are small ints
+STATIC const byte quicken_int_opcode[MP_BINARY_OP_NUM_BYTECODE] = {
+    [MP_BINARY_OP_LESS] = MP_BC_BINARY_OP_INT_LESS,
+    [MP_BINARY_OP_MORE] = MP_BC_BINARY_OP_INT_MORE,
+    [MP_BINARY_OP_LESS_EQUAL] = MP_BC_BINARY_OP_INT_LESS_EQUAL,
+    [MP_BINARY_OP_MORE_EQUAL] = MP_BC_BINARY_OP_INT_MORE_EQUAL,
+    [MP_BINARY_OP_INPLACE_ADD] = MP_BC_BINARY_OP_INT_INPLACE_ADD,
+    [MP_BINARY_OP_INPLACE_SUBTRACT] = MP_BC_BINARY_OP_INT_INPLACE_SUBTRACT,
+    [MP_BINARY_OP_ADD] = MP_BC_BINARY_OP_INT_ADD,
+    [MP_BINARY_OP_SUBTRACT] = MP_BC_BINARY_OP_INT_SUBTRACT,
+};
+
+// Does a binary op on two small ints without going through mp_binary_op.
+// Returns MP_OBJ_NULL if the op isn't handled here or the result doesn't fit
+// in a small int.
+static inline mp_obj_t quicken_small_int_op(mp_binary_op_t op, mp_obj_t lhs_in, mp_obj_t rhs_in) {
+    mp_int_t lhs = MP_OBJ_SMALL_INT_VALUE(lhs_in);
+    mp_int_t rhs = MP_OBJ_SMALL_INT_VALUE(rhs_in);
+    switch (op) {
+        case MP_BINARY_OP_LESS: return mp_obj_new_bool(lhs < rhs);
+        case MP_BINARY_OP_MORE: return mp_obj_new_bool(lhs > rhs);
+        case MP_BINARY_OP_EQUAL: return mp_obj_new_bool(lhs == rhs);
+        case MP_BINARY_OP_LESS_EQUAL: return mp_obj_new_bool(lhs <= rhs);
+        case MP_BINARY_OP_MORE_EQUAL: return mp_obj_new_bool(lhs >= rhs);
+        case MP_BINARY_OP_NOT_EQUAL: return mp_obj_new_bool(lhs != rhs);
+        case MP_BINARY_OP_INPLACE_OR:
+        case MP_BINARY_OP_OR: return MP_OBJ_NEW_SMALL_INT(lhs | rhs);
+        case MP_BINARY_OP_INPLACE_XOR:
+        case MP_BINARY_OP_XOR: return MP_OBJ_NEW_SMALL_INT(lhs ^ rhs);
+        case MP_BINARY_OP_INPLACE_AND:
+        case MP_BINARY_OP_AND: return MP_OBJ_NEW_SMALL_INT(lhs & rhs);
+        // small ints have a spare bit, so these can't overflow an mp_int_t
+        case MP_BINARY_OP_INPLACE_ADD:
+        case MP_BINARY_OP_ADD: lhs += rhs; break;
+        case MP_BINARY_OP_INPLACE_SUBTRACT:
+        case MP_BINARY_OP_SUBTRACT: lhs -= rhs; break;
+        default: return MP_OBJ_NULL;
+    }
+    if (!MP_SMALL_INT_FITS(lhs)) {
+        return MP_OBJ_NULL;
+    }
+    return MP_OBJ_NEW_SMALL_INT(lhs);
+}
+
+#if MICROPY_PY_BUILTINS_FLOAT
+
+// Specialised opcode for BINARY_OP_MULTI + op when one argument is a float
+// and the other is a float or a small int
+STATIC const byte quicken_float_opcode[MP_BINARY_OP_NUM_BYTECODE] = {
+    [MP_BINARY_OP_INPLACE_ADD] = MP_BC_BINARY_OP_FLOAT_INPLACE_ADD,
+    [MP_BINARY_OP_INPLACE_SUBTRACT] = MP_BC_BINARY_OP_FLOAT_INPLACE_SUBTRACT,
+    [MP_BINARY_OP_INPLACE_MULTIPLY] = MP_BC_BINARY_OP_FLOAT_INPLACE_MULTIPLY,
+    [MP_BINARY_OP_ADD] = MP_BC_BINARY_OP_FLOAT_ADD,
+    [MP_BINARY_OP_SUBTRACT] = MP_BC_BINARY_OP_FLOAT_SUBTRACT,
+    [MP_BINARY_OP_MULTIPLY] = MP_BC_BINARY_OP_FLOAT_MULTIPLY,
+};
+
+static inline bool quicken_get_float(mp_obj_t o, mp_float_t *f) {
+    if (mp_obj_is_float(o)) {
+        *f = mp_obj_float_get(o);
+        return true;
+    } else if (MP_OBJ_IS_SMALL_INT(o)) {
+        *f = (mp_float_t)MP_OBJ_SMALL_INT_VALUE(o);
+        return true;
+    }
+    return false;
+}
+
+// Gets the values of the arguments if they are a float and a float or small int
+static inline bool quicken_get_floats(mp_obj_t lhs_in, mp_obj_t rhs_in, mp_float_t *lhs, mp_float_t *rhs) {
+    return (mp_obj_is_float(lhs_in) || mp_obj_is_float(rhs_in))
+        && quicken_get_float(lhs_in, lhs) && quicken_get_float(rhs_in, rhs);
+}
+
+#endif
+
+// Rewrites the BINARY_OP_MULTI + op opcode at opcode_ptr into the form
+// specialised for the types of lhs and rhs, if there is one
+static inline void quicken_binary_op(const byte *opcode_ptr, mp_binary_op_t op, mp_obj_t lhs, mp_obj_t rhs) {
+    if (MP_OBJ_IS_SMALL_INT(lhs) && MP_OBJ_IS_SMALL_INT(rhs)) {
+        if (quicken_int_opcode[op] != 0) {
+            QUICKEN(opcode_ptr, quicken_int_opcode[op]);
+        }
+    #if MICROPY_PY_BUILTINS_FLOAT
+    } else if (quicken_float_opcode[op] != 0) {
+        mp_float_t lhs_val, rhs_val;
+        if (quicken_get_floats(lhs, rhs, &lhs_val, &rhs_val)) {
+            QUICKEN(opcode_ptr, quicken_float_opcode[op]);
+        }
+    #endif
+    }
+}
+
+#endif // MICROPY_OPT_QUICKEN
+
+#if MICROPY_OPT_FOR_ITER_INLINE
+
+// GET_ITER_STACK stores one of these in the iter_buf slots of the value stack
+// instead of an iterator object when iterating over a builtin sequence.  The
+// kind is a small int, so it can't be mistaken for the type of an iterator
+// object or for the MP_OBJ_NULL that marks an iterator on the heap.
+typedef struct _vm_iter_cursor_t {
+    mp_obj_t kind;
+    union {
+        struct {
+            mp_obj_t seq;
+            size_t cur;
+            size_t offset;
+        } seq;
+        struct {
+            mp_int_t cur;
+            mp_int_t stop;
+            mp_int_t step;
+        } range;
+    } u;
+} vm_iter_cursor_t;
+
+enum {
+    VM_ITER_RANGE,
+    VM_ITER_LIST,
+    VM_ITER_TUPLE,
+    VM_ITER_BYTES,
+    VM_ITER_ARRAY,
+};
+
+// Sets up a cursor over obj if it is one of the sequences FOR_ITER handles
+STATIC bool vm_iter_cursor_init(vm_iter_cursor_t *c, mp_obj_t obj) {
+    const mp_obj_type_t *type = mp_obj_get_type(obj);
+    if (type == &mp_type_range) {
+        mp_obj_range_t *range = MP_OBJ_TO_PTR(obj);
+        c->kind = MP_OBJ_NEW_SMALL_INT(VM_ITER_RANGE);
+        c->u.range.cur = range->start;
+        c->u.range.stop = range->stop;
+        c->u.range.step = range->step;
+        return true;
+    }
+    mp_int_t kind;
+    size_t offset = 0;
+    if (type == &mp_type_list) {
+        kind = VM_ITER_LIST;
+    } else if (type->getiter == mp_obj_tuple_getiter) {
+        kind = VM_ITER_TUPLE;
+    } else if (type == &mp_type_bytes) {
+        kind = VM_ITER_BYTES;
+    #if MICROPY_PY_BUILTINS_BYTEARRAY || MICROPY_PY_ARRAY || MICROPY_PY_BUILTINS_MEMORYVIEW
+    } else if (0
+        #if MICROPY_PY_BUILTINS_BYTEARRAY
+        || type == &mp_type_bytearray
+        #endif
+        #if MICROPY_PY_ARRAY
+        || type == &mp_type_array
+        #endif
+        #if MICROPY_PY_BUILTINS_MEMORYVIEW
+        || type == &mp_type_memoryview
+        #endif
+        ) {
+        kind = VM_ITER_ARRAY;
+        #if MICROPY_PY_BUILTINS_MEMORYVIEW
+        if (type == &mp_type_memoryview) {
+            offset = ((mp_obj_array_t*)MP_OBJ_TO_PTR(obj))->free;
+        }
+        #endif
+    #endif
+    } else {
+        return false;
+    }
+    c->kind = MP_OBJ_NEW_SMALL_INT(kind);
+    c->u.seq.seq = obj;
+    c->u.seq.cur = 0;
+    c->u.seq.offset = offset;
+    return true;
+}
+
+// Returns the next item of the sequence, or MP_OBJ_STOP_ITERATION at the end.
+// The length is read on every step because lists and bytearrays can change
+// size while they are being iterated over.
+static inline mp_obj_t vm_iter_cursor_next(vm_iter_cursor_t *c) {
+    switch (MP_OBJ_SMALL_INT_VALUE(c->kind)) {
+        case VM_ITER_RANGE: {
+            mp_int_t cur = c->u.range.cur;
+            if ((c->u.range.step > 0 && cur < c->u.range.stop) || (c->u.range.step < 0 && cur > c->u.range.stop)) {
+                c->u.range.cur = cur + c->u.range.step;
+                return MP_OBJ_NEW_SMALL_INT(cur);
+            }
+            break;
+        }
+        case VM_ITER_LIST: {
+            mp_obj_list_t *list = MP_OBJ_TO_PTR(c->u.seq.seq);
+            if (c->u.seq.cur < list->len) {
+                return list->items[c->u.seq.cur++];
+            }
+            break;
+        }
+        case VM_ITER_TUPLE: {
+            mp_obj_tuple_t *tuple = MP_OBJ_TO_PTR(c->u.seq.seq);
+            if (c->u.seq.cur < tuple->len) {
+                return tuple->items[c->u.seq.cur++];
+            }
+            break;
+        }
+        case VM_ITER_BYTES: {
+            GET_STR_DATA_LEN(c->u.seq.seq, data, len);
+            if (c->u.seq.cur < len) {
+                return MP_OBJ_NEW_SMALL_INT(data[c->u.seq.cur++]);
+            }
+            break;
+        }
+        #if MICROPY_PY_BUILTINS_BYTEARRAY || MICROPY_PY_ARRAY || MICROPY_PY_BUILTINS_MEMORYVIEW
+        default: {
+            mp_obj_array_t *array = MP_OBJ_TO_PTR(c->u.seq.seq);
+            if (c->u.seq.cur < array->len) {
+                size_t index = c->u.seq.offset + c->u.seq.cur++;
+                if (array->typecode == BYTEARRAY_TYPECODE) {
+                    return MP_OBJ_NEW_SMALL_INT(((byte*)array->items)[index]);
+                }
+                return mp_binary_get_val_array(array->typecode & ~MP_OBJ_ARRAY_TYPECODE_FLAG_RW, array->items, index);
+            }
+            break;
+        }
+        #endif
+    }
+    return MP_OBJ_STOP_ITERATION;
+}
+
+#endif // MICROPY_OPT_FOR_ITER_INLINE
+
 // fastn has items in reverse order (fastn[0] is local[0], fastn[-1] is local[1], etc)
 // sp points to bottom of stack which grows up
 // returns:
@@ -148,12 +408,84 @@ mp_vm_return_kind_t mp_execute_bytecode(mp_code_state_t *code_state, volatile mp
     // loop and the exception handler, leading to very obscure bugs.
     #define RAISE(o) do { nlr_pop(); nlr.ret_val = MP_OBJ_TO_PTR(o); goto exception_handler; } while (0)
 
+    #if MICROPY_OPT_QUICKEN
+    // Writes the generic opcode back over a specialised one whose operand types
+    // didn't match, and executes the generic opcode instead
+    #define UNQUICKEN(opcode_ptr, opcode) { ip = (opcode_ptr); *(byte*)ip = (opcode); DISPATCH(); }
+
+    #define ENTRY_BINARY_OP_INT(name) \
+        ENTRY(MP_BC_BINARY_OP_INT_##name): { \
+            mp_obj_t rhs = TOP(); \
+            mp_obj_t lhs = sp[-1]; \
+            if (!MP_OBJ_IS_SMALL_INT(lhs) || !MP_OBJ_IS_SMALL_INT(rhs)) { \
+                UNQUICKEN(ip - 1, MP_BC_BINARY_OP_MULTI + MP_BINARY_OP_##name); \
+            } \
+            mp_obj_t res = quicken_small_int_op(MP_BINARY_OP_##name, lhs, rhs); \
+            if (res == MP_OBJ_NULL) { \
+                MARK_EXC_IP_SELECTIVE(); \
+                res = mp_binary_op(MP_BINARY_OP_##name, lhs, rhs); \
+            } \
+            sp--; \
+            SET_TOP(res); \
+            DISPATCH(); \
+        }
+
+    #define ENTRY_BINARY_OP_FLOAT(name, c_op) \
+        ENTRY(MP_BC_BINARY_OP_FLOAT_##name): { \
+            MARK_EXC_IP_SELECTIVE(); \
+            mp_float_t lhs, rhs; \
+            if (!quicken_get_floats(sp[-1], TOP(), &lhs, &rhs)) { \
+                UNQUICKEN(ip - 1, MP_BC_BINARY_OP_MULTI + MP_BINARY_OP_##name); \
+            } \
+            sp--; \
+            SET_TOP(mp_obj_new_float(lhs c_op rhs)); \
+            DISPATCH(); \
+        }
+
+    #define ENTRY_LOAD_SUBSCR_INT(name, type, seq_type) \
+        ENTRY(MP_BC_LOAD_SUBSCR_##name##_INT): { \
+            mp_obj_t index = TOP(); \
+            if (!MP_OBJ_IS_TYPE(sp[-1], &type) || !MP_OBJ_IS_SMALL_INT(index)) { \
+                UNQUICKEN(ip - 1, MP_BC_LOAD_SUBSCR); \
+            } \
+            seq_type *seq = MP_OBJ_TO_PTR(sp[-1]); \
+            sp--; \
+            mp_int_t i = MP_OBJ_SMALL_INT_VALUE(index); \
+            if (i < 0) { \
+                i += seq->len; \
+            } \
+            if ((mp_uint_t)i < seq->len) { \
+                SET_TOP(seq->items[i]); \
+            } else { \
+                MARK_EXC_IP_SELECTIVE(); \
+                SET_TOP(mp_obj_subscr(MP_OBJ_FROM_PTR(seq), index, MP_OBJ_SENTINEL)); \
+            } \
+            DISPATCH(); \
+        }
+    #endif
+
+    #if MICROPY_GC_ALLOC_PROFILE
+    // Let the allocation profiler find the running instruction of each frame.
+    mp_code_state_t *const caller = MP_STATE_THREAD(current_code_state);
+    code_state->caller = caller;
+    MP_STATE_THREAD(current_code_state) = code_state;
+    #define VM_LEAVE() (MP_STATE_THREAD(current_code_state) = caller)
+    #else
+    #define VM_LEAVE()
+    #endif
+
 #if MICROPY_STACKLESS
 run_code_state: ;
 #endif
     // Pointers which are constant for particular invocation of mp_execute_bytecode()
     mp_obj_t * /*const*/ fastn;
     mp_exc_stack_t * /*const*/ exc_stack;
+    #if MICROPY_PERSISTENT_CODE_XIP
+    const uint16_t * /*const*/ qstr_table = code_state->fun_bc->qstr_table;
+    #if MICROPY_OPT_CACHE_MAP_LOOKUP_IN_BYTECODE
+    byte cache_scratch;
+    #endif
+    #endif
     {
         size_t n_state = mp_decode_uint_value(code_state->fun_bc->bytecode);
         fastn = &code_state->state[n_state - 1];
@@ -266,7 +598,22 @@ dispatch_loop:
                     goto load_check;
                 }
 
-                #if !MICROPY_OPT_CACHE_MAP_LOOKUP_IN_BYTECODE
+                #if MICROPY_OPT_LOAD_GLOBAL_CACHE
+                ENTRY(MP_BC_LOAD_NAME): {
+                    MARK_EXC_IP_SELECTIVE();
+                    const byte *site = ip;
+                    DECODE_QSTR;
+                    if (mp_locals_get() == mp_globals_get()) {
+                        PUSH(mp_load_global_cached(qst, code_state->fun_bc->bytecode, site));
+                    } else {
+                        PUSH(mp_load_name(qst));
+                    }
+                    #if MICROPY_OPT_CACHE_MAP_LOOKUP_IN_BYTECODE
+                    ip++; // skip the unused cache byte
+                    #endif
+                    DISPATCH();
+                }
+                #elif !MICROPY_OPT_CACHE_MAP_LOOKUP_IN_BYTECODE
                 ENTRY(MP_BC_LOAD_NAME): {
                     MARK_EXC_IP_SELECTIVE();
                     DECODE_QSTR;
@@ -284,7 +631,7 @@ dispatch_loop:
                     } else {
                         mp_map_elem_t *elem = mp_map_lookup(&mp_locals_get()->map, MP_OBJ_NEW_QSTR(qst), MP_MAP_LOOKUP);
                         if (elem != NULL) {
-                            *(byte*)ip = (elem - &mp_locals_get()->map.table[0]) & 0xff;
+                            CACHE_BYTE(ip) = (elem - &mp_locals_get()->map.table[0]) & 0xff;
                             PUSH(elem->value);
                         } else {
                             PUSH(mp_load_name(MP_OBJ_QSTR_VALUE(key)));
@@ -295,7 +642,18 @@ dispatch_loop:
                 }
                 #endif
 
-                #if !MICROPY_OPT_CACHE_MAP_LOOKUP_IN_BYTECODE
+                #if MICROPY_OPT_LOAD_GLOBAL_CACHE
+                ENTRY(MP_BC_LOAD_GLOBAL): {
+                    MARK_EXC_IP_SELECTIVE();
+                    const byte *site = ip;
+                    DECODE_QSTR;
+                    PUSH(mp_load_global_cached(qst, code_state->fun_bc->bytecode, site));
+                    #if MICROPY_OPT_CACHE_MAP_LOOKUP_IN_BYTECODE
+                    ip++; // skip the unused cache byte
+                    #endif
+                    DISPATCH();
+                }
+                #elif !MICROPY_OPT_CACHE_MAP_LOOKUP_IN_BYTECODE
                 ENTRY(MP_BC_LOAD_GLOBAL): {
                     MARK_EXC_IP_SELECTIVE();
                     DECODE_QSTR;
@@ -313,7 +671,7 @@ dispatch_loop:
                     } else {
                         mp_map_elem_t *elem = mp_map_lookup(&mp_globals_get()->map, MP_OBJ_NEW_QSTR(qst), MP_MAP_LOOKUP);
                         if (elem != NULL) {
-                            *(byte*)ip = (elem - &mp_globals_get()->map.table[0]) & 0xff;
+                            CACHE_BYTE(ip) = (elem - &mp_globals_get()->map.table[0]) & 0xff;
                             PUSH(elem->value);
                         } else {
                             PUSH(mp_load_global(MP_OBJ_QSTR_VALUE(key)));
@@ -336,7 +694,19 @@ dispatch_loop:
                     MARK_EXC_IP_SELECTIVE();
                     DECODE_QSTR;
                     mp_obj_t top = TOP();
-                    if (mp_obj_is_instance_type(mp_obj_get_type(top))) {
+                    const mp_obj_type_t *type = mp_obj_get_type(top);
+                    #if MICROPY_PY_SLOTS
+                    if (mp_obj_type_has_slots(type)) {
+                        mp_obj_t *slot = mp_obj_instance_slot_cached(top, qst, &CACHE_BYTE(ip));
+                        if (slot == NULL || *slot == MP_OBJ_NULL) {
+                            goto load_attr_cache_fail;
+                        }
+                        SET_TOP(*slot);
+                        ip++;
+                        DISPATCH();
+                    }
+                    #endif
+                    if (mp_obj_is_instance_type(type)) {
                         mp_obj_instance_t *self = MP_OBJ_TO_PTR(top);
                         mp_uint_t x = *ip;
                         mp_obj_t key = MP_OBJ_NEW_QSTR(qst);
@@ -346,7 +716,7 @@ dispatch_loop:
                         } else {
                             elem = mp_map_lookup(&self->members, key, MP_MAP_LOOKUP);
                             if (elem != NULL) {
-                                *(byte*)ip = elem - &self->members.table[0];
+                                CACHE_BYTE(ip) = elem - &self->members.table[0];
                             } else {
                                 goto load_attr_cache_fail;
                             }
@@ -365,6 +735,15 @@ dispatch_loop:
                 ENTRY(MP_BC_LOAD_METHOD): {
                     MARK_EXC_IP_SELECTIVE();
                     DECODE_QSTR;
+                    #if MICROPY_OPT_TYPE_ATTR_CACHE
+                    mp_obj_t meth = mp_obj_load_method_cached(*sp, qst);
+                    if (meth != MP_OBJ_NULL) {
+                        sp[1] = sp[0];
+                        sp[0] = meth;
+                        sp += 1;
+                        DISPATCH();
+                    }
+                    #endif
                     mp_load_method(*sp, qst, sp);
                     sp += 1;
                     DISPATCH();
@@ -378,6 +757,162 @@ dispatch_loop:
                     DISPATCH();
                 }
 
+                ENTRY(MP_BC_LOAD_FAST_ATTR): {
+                    MARK_EXC_IP_SELECTIVE();
+                    DECODE_QSTR;
+                    mp_obj_t obj = fastn[-(mp_int_t)*ip++];
+                    if (obj == MP_OBJ_NULL) {
+                        goto local_name_error;
+                    }
+                    const mp_obj_type_t *type = mp_obj_get_type(obj);
+                    #if MICROPY_PY_SLOTS
+                    if (mp_obj_type_has_slots(type)) {
+                        // assigned slots of an instance are found before anything in its class
+                        mp_int_t i = mp_obj_type_slot_index(type, qst);
+                        if (i >= 0) {
+                            mp_obj_t value = ((mp_obj_slots_instance_t*)MP_OBJ_TO_PTR(obj))->slots[i];
+                            if (value != MP_OBJ_NULL) {
+                                PUSH(value);
+                                DISPATCH();
+                            }
+                        }
+                    } else
+                    #endif
+                    if (mp_obj_is_instance_type(type)) {
+                        // members of an instance are found before anything in its class
+                        mp_obj_instance_t *self = MP_OBJ_TO_PTR(obj);
+                        mp_map_elem_t *elem = mp_map_lookup(&self->members, MP_OBJ_NEW_QSTR(qst), MP_MAP_LOOKUP);
+                        if (elem != NULL) {
+                            PUSH(elem->value);
+                            DISPATCH();
+                        }
+                    }
+                    PUSH(mp_load_attr(obj, qst));
+                    DISPATCH();
+                }
+
+                ENTRY(MP_BC_LOAD_FAST_METHOD): {
+                    MARK_EXC_IP_SELECTIVE();
+                    DECODE_QSTR;
+                    mp_obj_t obj = fastn[-(mp_int_t)*ip++];
+                    if (obj == MP_OBJ_NULL) {
+                        goto local_name_error;
+                    }
+                    #if MICROPY_OPT_TYPE_ATTR_CACHE
+                    mp_obj_t meth = mp_obj_load_method_cached(obj, qst);
+                    if (meth != MP_OBJ_NULL) {
+                        sp[1] = meth;
+                        sp[2] = obj;
+                        sp += 2;
+                        DISPATCH();
+                    }
+                    #endif
+                    mp_load_method(obj, qst, sp + 1);
+                    sp += 2;
+                    DISPATCH();
+                }
+
+                ENTRY(MP_BC_BINARY_OP_FAST_FAST): {
+                    MARK_EXC_IP_SELECTIVE();
+                    mp_obj_t lhs = fastn[-(mp_int_t)ip[0]];
+                    mp_obj_t rhs = fastn[-(mp_int_t)ip[1]];
+                    mp_binary_op_t op = ip[2];
+                    ip += 3;
+                    if (lhs == MP_OBJ_NULL || rhs == MP_OBJ_NULL) {
+                        goto local_name_error;
+                    }
+                    #if MICROPY_OPT_QUICKEN
+                    if (MP_OBJ_IS_SMALL_INT(lhs) && MP_OBJ_IS_SMALL_INT(rhs)) {
+                        mp_obj_t res = quicken_small_int_op(op, lhs, rhs);
+                        if (res != MP_OBJ_NULL) {
+                            QUICKEN(ip - 4, MP_BC_BINARY_OP_FAST_FAST_INT);
+                            PUSH(res);
+                            DISPATCH();
+                        }
+                    }
+                    #endif
+                    PUSH(mp_binary_op(op, lhs, rhs));
+                    DISPATCH();
+                }
+
+                ENTRY(MP_BC_BINARY_OP_FAST_SMALL_INT): {
+                    MARK_EXC_IP_SELECTIVE();
+                    #if MICROPY_OPT_QUICKEN
+                    const byte *opcode_ptr = ip - 1;
+                    #endif
+                    mp_int_t num = 0;
+                    if ((ip[0] & 0x40) != 0) {
+                        // Number is negative
+                        num--;
+                    }
+                    do {
+                        num = (num << 7) | (*ip & 0x7f);
+                    } while ((*ip++ & 0x80) != 0);
+                    mp_obj_t lhs = fastn[-(mp_int_t)ip[0]];
+                    mp_binary_op_t op = ip[1];
+                    ip += 2;
+                    if (lhs == MP_OBJ_NULL) {
+                        goto local_name_error;
+                    }
+                    #if MICROPY_OPT_QUICKEN
+                    if (MP_OBJ_IS_SMALL_INT(lhs)) {
+                        mp_obj_t res = quicken_small_int_op(op, lhs, MP_OBJ_NEW_SMALL_INT(num));
+                        if (res != MP_OBJ_NULL) {
+                            QUICKEN(opcode_ptr, MP_BC_BINARY_OP_FAST_SMALL_INT_INT);
+                            PUSH(res);
+                            DISPATCH();
+                        }
+                    }
+                    #endif
+                    PUSH(mp_binary_op(op, lhs, MP_OBJ_NEW_SMALL_INT(num)));
+                    DISPATCH();
+                }
+
+                #if MICROPY_OPT_QUICKEN
+                ENTRY(MP_BC_BINARY_OP_FAST_FAST_INT): {
+                    mp_obj_t lhs = fastn[-(mp_int_t)ip[0]];
+                    mp_obj_t rhs = fastn[-(mp_int_t)ip[1]];
+                    mp_binary_op_t op = ip[2];
+                    if (!MP_OBJ_IS_SMALL_INT(lhs) || !MP_OBJ_IS_SMALL_INT(rhs)) {
+                        UNQUICKEN(ip - 1, MP_BC_BINARY_OP_FAST_FAST);
+                    }
+                    ip += 3;
+                    mp_obj_t res = quicken_small_int_op(op, lhs, rhs);
+                    if (res == MP_OBJ_NULL) {
+                        MARK_EXC_IP_SELECTIVE();
+                        res = mp_binary_op(op, lhs, rhs);
+                    }
+                    PUSH(res);
+                    DISPATCH();
+                }
+
+                ENTRY(MP_BC_BINARY_OP_FAST_SMALL_INT_INT): {
+                    const byte *opcode_ptr = ip - 1;
+                    mp_int_t num = 0;
+                    if ((ip[0] & 0x40) != 0) {
+                        // Number is negative
+                        num--;
+                    }
+                    do {
+                        num = (num << 7) | (*ip & 0x7f);
+                    } while ((*ip++ & 0x80) != 0);
+                    mp_obj_t lhs = fastn[-(mp_int_t)ip[0]];
+                    mp_binary_op_t op = ip[1];
+                    if (!MP_OBJ_IS_SMALL_INT(lhs)) {
+                        UNQUICKEN(opcode_ptr, MP_BC_BINARY_OP_FAST_SMALL_INT);
+                    }
+                    ip += 2;
+                    mp_obj_t rhs = MP_OBJ_NEW_SMALL_INT(num);
+                    mp_obj_t res = quicken_small_int_op(op, lhs, rhs);
+                    if (res == MP_OBJ_NULL) {
+                        MARK_EXC_IP_SELECTIVE();
+                        res = mp_binary_op(op, lhs, rhs);
+                    }
+                    PUSH(res);
+                    DISPATCH();
+                }
+                #endif
+
                 ENTRY(MP_BC_LOAD_BUILD_CLASS):
                     MARK_EXC_IP_SELECTIVE();
                     PUSH(mp_load_build_class());
@@ -386,10 +921,24 @@ dispatch_loop:
                 ENTRY(MP_BC_LOAD_SUBSCR): {
                     MARK_EXC_IP_SELECTIVE();
                     mp_obj_t index = POP();
+                    #if MICROPY_OPT_QUICKEN
+                    if (MP_OBJ_IS_SMALL_INT(index)) {
+                        if (MP_OBJ_IS_TYPE(TOP(), &mp_type_list)) {
+                            QUICKEN(ip - 1, MP_BC_LOAD_SUBSCR_LIST_INT);
+                        } else if (MP_OBJ_IS_TYPE(TOP(), &mp_type_tuple)) {
+                            QUICKEN(ip - 1, MP_BC_LOAD_SUBSCR_TUPLE_INT);
+                        }
+                    }
+                    #endif
                     SET_TOP(mp_obj_subscr(TOP(), index, MP_OBJ_SENTINEL));
                     DISPATCH();
                 }
 
+                #if MICROPY_OPT_QUICKEN
+                ENTRY_LOAD_SUBSCR_INT(LIST, mp_type_list, mp_obj_list_t)
+                ENTRY_LOAD_SUBSCR_INT(TUPLE, mp_type_tuple, mp_obj_tuple_t)
+                #endif
+
                 ENTRY(MP_BC_STORE_FAST_N): {
                     DECODE_UINT;
                     fastn[-unum] = POP();
@@ -434,7 +983,23 @@ dispatch_loop:
                     MARK_EXC_IP_SELECTIVE();
                     DECODE_QSTR;
                     mp_obj_t top = TOP();
-                    if (mp_obj_is_instance_type(mp_obj_get_type(top)) && sp[-1] != MP_OBJ_NULL) {
+                    const mp_obj_type_t *type = mp_obj_get_type(top);
+                    #if MICROPY_PY_SLOTS
+                    // Slots always exist, so here the class must be checked for
+                    // properties and descriptors that take over the store
+                    if (mp_obj_type_has_slots(type)) {
+                        mp_obj_t *slot;
+                        if (sp[-1] == MP_OBJ_NULL || (type->flags & TYPE_FLAG_HAS_SPECIAL_ACCESSORS)
+                            || (slot = mp_obj_instance_slot_cached(top, qst, &CACHE_BYTE(ip))) == NULL) {
+                            goto store_attr_cache_fail;
+                        }
+                        *slot = sp[-1];
+                        sp -= 2;
+                        ip++;
+                        DISPATCH();
+                    }
+                    #endif
+                    if (mp_obj_is_instance_type(type) && sp[-1] != MP_OBJ_NULL) {
                         mp_obj_instance_t *self = MP_OBJ_TO_PTR(top);
                         mp_uint_t x = *ip;
                         mp_obj_t key = MP_OBJ_NEW_QSTR(qst);
@@ -444,7 +1009,7 @@ dispatch_loop:
                         } else {
                             elem = mp_map_lookup(&self->members, key, MP_MAP_LOOKUP);
                             if (elem != NULL) {
-                                *(byte*)ip = elem - &self->members.table[0];
+                                CACHE_BYTE(ip) = elem - &self->members.table[0];
                             } else {
                                 goto store_attr_cache_fail;
                             }
@@ -732,6 +1297,12 @@ unwind_jump:;
                     mp_obj_t obj = TOP();
                     mp_obj_iter_buf_t *iter_buf = (mp_obj_iter_buf_t*)sp;
                     sp += MP_OBJ_ITER_BUF_NSLOTS - 1;
+                    #if MICROPY_OPT_FOR_ITER_INLINE
+                    MP_STATIC_ASSERT(sizeof(vm_iter_cursor_t) <= MP_OBJ_ITER_BUF_NSLOTS * sizeof(mp_obj_t));
+                    if (vm_iter_cursor_init((vm_iter_cursor_t*)iter_buf, obj)) {
+                        DISPATCH();
+                    }
+                    #endif
                     obj = mp_getiter(obj, iter_buf);
                     if (obj != MP_OBJ_FROM_PTR(iter_buf)) {
                         // Iterator didn't use the stack so indicate that with MP_OBJ_NULL.
@@ -745,21 +1316,110 @@ unwind_jump:;
                     MARK_EXC_IP_SELECTIVE();
                     DECODE_ULABEL; // the jump offset if iteration finishes; for labels are always forward
                     code_state->sp = sp;
+                    mp_obj_t value;
+                    #if MICROPY_OPT_FOR_ITER_INLINE
+                    if (MP_OBJ_IS_SMALL_INT(sp[-MP_OBJ_ITER_BUF_NSLOTS + 1])) {
+                        value = vm_iter_cursor_next((vm_iter_cursor_t*)&sp[-MP_OBJ_ITER_BUF_NSLOTS + 1]);
+                    } else
+                    #endif
+                    {
+                        mp_obj_t obj;
+                        if (sp[-MP_OBJ_ITER_BUF_NSLOTS + 1] == MP_OBJ_NULL) {
+                            obj = sp[-MP_OBJ_ITER_BUF_NSLOTS + 2];
+                        } else {
+                            obj = MP_OBJ_FROM_PTR(&sp[-MP_OBJ_ITER_BUF_NSLOTS + 1]);
+                        }
+                        #if MICROPY_OPT_QUICKEN
+                        if (MP_OBJ_IS_TYPE(obj, &mp_type_range_it)) {
+                            QUICKEN(ip - 3, MP_BC_FOR_ITER_RANGE);
+                        }
+                        #endif
+                        value = mp_iternext_allow_raise(obj);
+                    }
+                    if (value == MP_OBJ_STOP_ITERATION) {
+                        sp -= MP_OBJ_ITER_BUF_NSLOTS; // pop the exhausted iterator
+                        ip += ulab; // jump to after for-block
+                    } else {
+                        PUSH(value); // push the next iteration value
+                    }
+                    DISPATCH_WITH_PEND_EXC_CHECK();
+                }
+
+                ENTRY(MP_BC_FOR_ITER_UNPACK): {
+                    MARK_EXC_IP_SELECTIVE();
+                    DECODE_ULABEL; // the jump offset if iteration finishes; for labels are always forward
+                    size_t n = *ip;
+                    code_state->sp = sp;
+                    mp_obj_t value;
+                    #if MICROPY_OPT_FOR_ITER_INLINE
+                    if (MP_OBJ_IS_SMALL_INT(sp[-MP_OBJ_ITER_BUF_NSLOTS + 1])) {
+                        value = vm_iter_cursor_next((vm_iter_cursor_t*)&sp[-MP_OBJ_ITER_BUF_NSLOTS + 1]);
+                    } else
+                    #endif
+                    {
+                        mp_obj_t obj;
+                        if (sp[-MP_OBJ_ITER_BUF_NSLOTS + 1] == MP_OBJ_NULL) {
+                            obj = sp[-MP_OBJ_ITER_BUF_NSLOTS + 2];
+                        } else {
+                            obj = MP_OBJ_FROM_PTR(&sp[-MP_OBJ_ITER_BUF_NSLOTS + 1]);
+                        }
+                        // store the values of enumerate, zip and dict.items() without a tuple
+                        value = MP_OBJ_NULL;
+                        const mp_obj_type_t *type = mp_obj_get_type(obj);
+                        #if MICROPY_PY_BUILTINS_ENUMERATE
+                        if (type == &mp_type_enumerate) {
+                            value = mp_obj_enumerate_iternext_unpack(obj, n, sp + 1);
+                        } else
+                        #endif
+                        if (type == &mp_type_zip) {
+                            value = mp_obj_zip_iternext_unpack(obj, n, sp + 1);
+                        } else if (type == &mp_type_dict_view_it) {
+                            value = mp_obj_dict_view_it_iternext_unpack(obj, n, sp + 1);
+                        }
+                        if (value == mp_const_none) {
+                            sp += n;
+                            ip += 1;
+                            DISPATCH_WITH_PEND_EXC_CHECK();
+                        } else if (value == MP_OBJ_NULL) {
+                            value = mp_iternext_allow_raise(obj);
+                        }
+                    }
+                    if (value == MP_OBJ_STOP_ITERATION) {
+                        sp -= MP_OBJ_ITER_BUF_NSLOTS; // pop the exhausted iterator
+                        ip += ulab; // jump to after for-block
+                    } else {
+                        PUSH(value);
+                        mp_unpack_sequence(value, n, sp);
+                        sp += n - 1;
+                        ip += 1;
+                    }
+                    DISPATCH_WITH_PEND_EXC_CHECK();
+                }
+
+                #if MICROPY_OPT_QUICKEN
+                ENTRY(MP_BC_FOR_ITER_RANGE): {
                     mp_obj_t obj;
                     if (sp[-MP_OBJ_ITER_BUF_NSLOTS + 1] == MP_OBJ_NULL) {
                         obj = sp[-MP_OBJ_ITER_BUF_NSLOTS + 2];
                     } else {
                         obj = MP_OBJ_FROM_PTR(&sp[-MP_OBJ_ITER_BUF_NSLOTS + 1]);
                     }
-                    mp_obj_t value = mp_iternext_allow_raise(obj);
-                    if (value == MP_OBJ_STOP_ITERATION) {
+                    if (!MP_OBJ_IS_TYPE(obj, &mp_type_range_it)) {
+                        UNQUICKEN(ip - 1, MP_BC_FOR_ITER);
+                    }
+                    DECODE_ULABEL; // the jump offset if iteration finishes; for labels are always forward
+                    mp_obj_range_it_t *range_it = MP_OBJ_TO_PTR(obj);
+                    if ((range_it->step > 0 && range_it->cur < range_it->stop)
+                        || (range_it->step < 0 && range_it->cur > range_it->stop)) {
+                        PUSH(MP_OBJ_NEW_SMALL_INT(range_it->cur));
+                        range_it->cur += range_it->step;
+                    } else {
                         sp -= MP_OBJ_ITER_BUF_NSLOTS; // pop the exhausted iterator
                         ip += ulab; // jump to after for-block
-                    } else {
-                        PUSH(value); // push the next iteration value
                     }
                     DISPATCH_WITH_PEND_EXC_CHECK();
                 }
+                #endif
 
                 // matched against: SETUP_EXCEPT, SETUP_FINALLY, SETUP_WITH
                 ENTRY(MP_BC_POP_BLOCK):
@@ -1118,6 +1778,7 @@ unwind_return:
                         goto run_code_state;
                     }
                     #endif
+                    VM_LEAVE();
                     return MP_VM_RETURN_NORMAL;
 
                 ENTRY(MP_BC_RAISE_VARARGS): {
@@ -1155,6 +1816,7 @@ yield:
                     code_state->ip = ip;
                     code_state->sp = sp;
                     code_state->exc_sp = MP_TAGPTR_MAKE(exc_sp, currently_in_except_block);
+                    VM_LEAVE();
                     return MP_VM_RETURN_YIELD;
 
                 ENTRY(MP_BC_YIELD_FROM): {
@@ -1231,6 +1893,25 @@ yield:
                     mp_import_all(POP());
                     DISPATCH();
 
+                #if MICROPY_OPT_QUICKEN
+                ENTRY_BINARY_OP_INT(ADD)
+                ENTRY_BINARY_OP_INT(SUBTRACT)
+                ENTRY_BINARY_OP_INT(INPLACE_ADD)
+                ENTRY_BINARY_OP_INT(INPLACE_SUBTRACT)
+                ENTRY_BINARY_OP_INT(LESS)
+                ENTRY_BINARY_OP_INT(MORE)
+                ENTRY_BINARY_OP_INT(LESS_EQUAL)
+                ENTRY_BINARY_OP_INT(MORE_EQUAL)
+                #if MICROPY_PY_BUILTINS_FLOAT
+                ENTRY_BINARY_OP_FLOAT(ADD, +)
+                ENTRY_BINARY_OP_FLOAT(SUBTRACT, -)
+                ENTRY_BINARY_OP_FLOAT(MULTIPLY, *)
+                ENTRY_BINARY_OP_FLOAT(INPLACE_ADD, +)
+                ENTRY_BINARY_OP_FLOAT(INPLACE_SUBTRACT, -)
+                ENTRY_BINARY_OP_FLOAT(INPLACE_MULTIPLY, *)
+                #endif
+                #endif
+
 #if MICROPY_OPT_COMPUTED_GOTO
                 ENTRY(MP_BC_LOAD_CONST_SMALL_INT_MULTI):
                     PUSH(MP_OBJ_NEW_SMALL_INT((mp_int_t)ip[-1] - MP_BC_LOAD_CONST_SMALL_INT_MULTI - 16));
@@ -1251,9 +1932,13 @@ yield:
 
                 ENTRY(MP_BC_BINARY_OP_MULTI): {
                     MARK_EXC_IP_SELECTIVE();
+                    mp_binary_op_t op = ip[-1] - MP_BC_BINARY_OP_MULTI;
                     mp_obj_t rhs = POP();
                     mp_obj_t lhs = TOP();
-                    SET_TOP(mp_binary_op(ip[-1] - MP_BC_BINARY_OP_MULTI, lhs, rhs));
+                    #if MICROPY_OPT_QUICKEN
+                    quicken_binary_op(ip - 1, op, lhs, rhs);
+                    #endif
+                    SET_TOP(mp_binary_op(op, lhs, rhs));
                     DISPATCH();
                 }
 
@@ -1274,9 +1959,13 @@ yield:
                         SET_TOP(mp_unary_op(ip[-1] - MP_BC_UNARY_OP_MULTI, TOP()));
                         DISPATCH();
                     } else if (ip[-1] < MP_BC_BINARY_OP_MULTI + MP_BINARY_OP_NUM_BYTECODE) {
+                        mp_binary_op_t op = ip[-1] - MP_BC_BINARY_OP_MULTI;
                         mp_obj_t rhs = POP();
                         mp_obj_t lhs = TOP();
-                        SET_TOP(mp_binary_op(ip[-1] - MP_BC_BINARY_OP_MULTI, lhs, rhs));
+                        #if MICROPY_OPT_QUICKEN
+                        quicken_binary_op(ip - 1, op, lhs, rhs);
+                        #endif
+                        SET_TOP(mp_binary_op(op, lhs, rhs));
                         DISPATCH();
                     } else
 #endif
@@ -1284,6 +1973,7 @@ yield:
                     mp_obj_t obj = mp_obj_new_exception_msg(&mp_type_NotImplementedError, translate("byte code not implemented"));
                     nlr_pop();
                     fastn[0] = obj;
+                    VM_LEAVE();
                     return MP_VM_RETURN_EXCEPTION;
                 }
 
@@ -1357,7 +2047,7 @@ exception_handler:
             if (mp_obj_is_subclass_fast(MP_OBJ_FROM_PTR(((mp_obj_base_t*)nlr.ret_val)->type), MP_OBJ_FROM_PTR(&mp_type_StopIteration))) {
                 if (code_state->ip) {
                     // check if it's a StopIteration within a for block
-                    if (*code_state->ip == MP_BC_FOR_ITER) {
+                    if (*code_state->ip == MP_BC_FOR_ITER || *code_state->ip == MP_BC_FOR_ITER_UNPACK) {
                         const byte *ip = code_state->ip + 1;
                         DECODE_ULABEL; // the jump offset if iteration finishes; for labels are always forward
                         code_state->ip = ip + ulab; // jump to after for-block
@@ -1381,50 +2071,10 @@ unwind_loop:
             // TODO: don't set traceback for exceptions re-raised by END_FINALLY.
             // But consider how to handle nested exceptions.
             if (nlr.ret_val != &mp_const_GeneratorExit_obj) {
-                const byte *ip = code_state->fun_bc->bytecode;
-                ip = mp_decode_uint_skip(ip); // skip n_state
-                ip = mp_decode_uint_skip(ip); // skip n_exc_stack
-                ip++; // skip scope_params
-                ip++; // skip n_pos_args
-                ip++; // skip n_kwonly_args
-                ip++; // skip n_def_pos_args
-                size_t bc = code_state->ip - ip;
-                size_t code_info_size = mp_decode_uint_value(ip);
-                ip = mp_decode_uint_skip(ip); // skip code_info_size
-                bc -= code_info_size;
-                #if MICROPY_PERSISTENT_CODE
-                qstr block_name = ip[0] | (ip[1] << 8);
-                qstr source_file = ip[2] | (ip[3] << 8);
-                ip += 4;
-                #else
-                qstr block_name = mp_decode_uint_value(ip);
-                ip = mp_decode_uint_skip(ip);
-                qstr source_file = mp_decode_uint_value(ip);
-                ip = mp_decode_uint_skip(ip);
-                #endif
-                size_t source_line = 1;
-                size_t c;
-                while ((c = *ip)) {
-                    size_t b, l;
-                    if ((c & 0x80) == 0) {
-                        // 0b0LLBBBBB encoding
-                        b = c & 0x1f;
-                        l = c >> 5;
-                        ip += 1;
-                    } else {
-                        // 0b1LLLBBBB 0bLLLLLLLL encoding (l's LSB in second byte)
-                        b = c & 0xf;
-                        l = ((c << 4) & 0x700) | ip[1];
-                        ip += 2;
-                    }
-                    if (bc >= b) {
-                        bc -= b;
-                        source_line += l;
-                    } else {
-                        // found source line corresponding to bytecode offset
-                        break;
-                    }
-                }
+                qstr block_name;
+                qstr source_file;
+                size_t source_line;
+                mp_code_state_get_location(code_state, &block_name, &source_file, &source_line);
                 mp_obj_exception_add_traceback(MP_OBJ_FROM_PTR(nlr.ret_val), source_file, source_line, block_name);
             }
 
@@ -1468,6 +2118,9 @@ unwind_loop:
                 size_t n_state = mp_decode_uint_value(code_state->fun_bc->bytecode);
                 fastn = &code_state->state[n_state - 1];
                 exc_stack = (mp_exc_stack_t*)(code_state->state + n_state);
+                #if MICROPY_PERSISTENT_CODE_XIP
+                qstr_table = code_state->fun_bc->qstr_table;
+                #endif
                 // variables that are visible to the exception handler (declared volatile)
                 currently_in_except_block = MP_TAGPTR_TAG0(code_state->exc_sp); // 0 or 1, to detect nested exceptions
                 exc_sp = MP_TAGPTR_PTR(code_state->exc_sp); // stack grows up, exc_sp points to top of stack
@@ -1478,6 +2131,7 @@ unwind_loop:
                 // propagate exception to higher level
                 // TODO what to do about ip and sp? they don't really make sense at this point
                 fastn[0] = MP_OBJ_FROM_PTR(nlr.ret_val); // must put exception here because sp is invalid
+                VM_LEAVE();
                 return MP_VM_RETURN_EXCEPTION;
             }
         }
@@ -75,7 +75,12 @@ static const void *const entry_table[256] = {
     [MP_BC_END_FINALLY] = &&entry_MP_BC_END_FINALLY,
     [MP_BC_GET_ITER] = &&entry_MP_BC_GET_ITER,
     [MP_BC_GET_ITER_STACK] = &&entry_MP_BC_GET_ITER_STACK,
+    [MP_BC_LOAD_FAST_ATTR] = &&entry_MP_BC_LOAD_FAST_ATTR,
+    [MP_BC_LOAD_FAST_METHOD] = &&entry_MP_BC_LOAD_FAST_METHOD,
+    [MP_BC_BINARY_OP_FAST_FAST] = &&entry_MP_BC_BINARY_OP_FAST_FAST,
+    [MP_BC_BINARY_OP_FAST_SMALL_INT] = &&entry_MP_BC_BINARY_OP_FAST_SMALL_INT,
     [MP_BC_FOR_ITER] = &&entry_MP_BC_FOR_ITER,
+    [MP_BC_FOR_ITER_UNPACK] = &&entry_MP_BC_FOR_ITER_UNPACK,
     [MP_BC_POP_BLOCK] = &&entry_MP_BC_POP_BLOCK,
     [MP_BC_POP_EXCEPT] = &&entry_MP_BC_POP_EXCEPT,
     [MP_BC_BUILD_TUPLE] = &&entry_MP_BC_BUILD_TUPLE,
@@ -106,6 +111,29 @@ static const void *const entry_table[256] = {
     [MP_BC_IMPORT_NAME] = &&entry_MP_BC_IMPORT_NAME,
     [MP_BC_IMPORT_FROM] = &&entry_MP_BC_IMPORT_FROM,
     [MP_BC_IMPORT_STAR] = &&entry_MP_BC_IMPORT_STAR,
+    #if MICROPY_OPT_QUICKEN
+    [MP_BC_BINARY_OP_INT_ADD] = &&entry_MP_BC_BINARY_OP_INT_ADD,
+    [MP_BC_BINARY_OP_INT_SUBTRACT] = &&entry_MP_BC_BINARY_OP_INT_SUBTRACT,
+    [MP_BC_BINARY_OP_INT_INPLACE_ADD] = &&entry_MP_BC_BINARY_OP_INT_INPLACE_ADD,
+    [MP_BC_BINARY_OP_INT_INPLACE_SUBTRACT] = &&entry_MP_BC_BINARY_OP_INT_INPLACE_SUBTRACT,
+    [MP_BC_BINARY_OP_INT_LESS] = &&entry_MP_BC_BINARY_OP_INT_LESS,
+    [MP_BC_BINARY_OP_INT_MORE] = &&entry_MP_BC_BINARY_OP_INT_MORE,
+    [MP_BC_BINARY_OP_INT_LESS_EQUAL] = &&entry_MP_BC_BINARY_OP_INT_LESS_EQUAL,
+    [MP_BC_BINARY_OP_INT_MORE_EQUAL] = &&entry_MP_BC_BINARY_OP_INT_MORE_EQUAL,
+    #if MICROPY_PY_BUILTINS_FLOAT
+    [MP_BC_BINARY_OP_FLOAT_ADD] = &&entry_MP_BC_BINARY_OP_FLOAT_ADD,
+    [MP_BC_BINARY_OP_FLOAT_SUBTRACT] = &&entry_MP_BC_BINARY_OP_FLOAT_SUBTRACT,
+    [MP_BC_BINARY_OP_FLOAT_MULTIPLY] = &&entry_MP_BC_BINARY_OP_FLOAT_MULTIPLY,
+    [MP_BC_BINARY_OP_FLOAT_INPLACE_ADD] = &&entry_MP_BC_BINARY_OP_FLOAT_INPLACE_ADD,
+    [MP_BC_BINARY_OP_FLOAT_INPLACE_SUBTRACT] = &&entry_MP_BC_BINARY_OP_FLOAT_INPLACE_SUBTRACT,
+    [MP_BC_BINARY_OP_FLOAT_INPLACE_MULTIPLY] = &&entry_MP_BC_BINARY_OP_FLOAT_INPLACE_MULTIPLY,
+    #endif
+    [MP_BC_LOAD_SUBSCR_LIST_INT] = &&entry_MP_BC_LOAD_SUBSCR_LIST_INT,
+    [MP_BC_LOAD_SUBSCR_TUPLE_INT] = &&entry_MP_BC_LOAD_SUBSCR_TUPLE_INT,
+    [MP_BC_FOR_ITER_RANGE] = &&entry_MP_BC_FOR_ITER_RANGE,
+    [MP_BC_BINARY_OP_FAST_FAST_INT] = &&entry_MP_BC_BINARY_OP_FAST_FAST_INT,
+    [MP_BC_BINARY_OP_FAST_SMALL_INT_INT] = &&entry_MP_BC_BINARY_OP_FAST_SMALL_INT_INT,
+    #endif
     [MP_BC_LOAD_CONST_SMALL_INT_MULTI ... MP_BC_LOAD_CONST_SMALL_INT_MULTI + 63] = &&entry_MP_BC_LOAD_CONST_SMALL_INT_MULTI,
     [MP_BC_LOAD_FAST_MULTI ... MP_BC_LOAD_FAST_MULTI + 15] = &&entry_MP_BC_LOAD_FAST_MULTI,
     [MP_BC_STORE_FAST_MULTI ... MP_BC_STORE_FAST_MULTI + 15] = &&entry_MP_BC_STORE_FAST_MULTI,
@@ -228,7 +228,9 @@ static uint32_t type_size(uint8_t indent_level, mp_obj_type_t *type) {
 static uint32_t instance_size(uint8_t indent_level, mp_obj_instance_t *instance) {
     uint32_t total_size = gc_nbytes(instance);
 
-    total_size += map_size(indent_level, &instance->members);
+    if (!mp_obj_type_has_slots(instance->base.type)) {
+        total_size += map_size(indent_level, &instance->members);
+    }
 
     return total_size;
 }
@@ -25,6 +25,9 @@
  */
 
 #include "supervisor/shared/tick.h"
+
+#include "py/gc.h"
+
 #include "supervisor/filesystem.h"
 #include "supervisor/shared/autoreload.h"
 
@@ -86,6 +89,11 @@ void supervisor_run_background_tasks_if_tick() {
     background_ticks_ms32 = now32;
 
     run_background_tasks();
+
+    #if MICROPY_GC_INCREMENTAL_SWEEP
+    // Spread the sweep after an automatic collection over background ticks.
+    gc_sweep_step();
+    #endif
 }
 
 void supervisor_fake_tick() {
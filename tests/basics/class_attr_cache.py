@@ -0,0 +1,70 @@
+# test that attribute lookups on classes see changes made after a lookup
+
+class A:
+    def f(self):
+        return "A.f"
+
+class B(A):
+    pass
+
+b = B()
+
+def call_f(o):
+    return o.f()
+
+# prime any cache, then change the method in the class and its base
+print(call_f(b))
+A.f = lambda self: "new A.f"
+print(call_f(b))
+B.f = lambda self: "B.f"
+print(call_f(b))
+del B.f
+print(call_f(b))
+
+# an instance attribute shadows the class method
+b.f = lambda: "instance f"
+print(call_f(b))
+del b.f
+print(call_f(b))
+
+# a missing attribute, then added to the base class
+def get_g(o):
+    try:
+        return o.g
+    except AttributeError:
+        return "no g"
+
+print(get_g(b))
+A.g = 1
+print(get_g(b))
+b.g = 2
+print(get_g(b), B.g)
+
+# static and class methods found through the hierarchy
+class C(B):
+    @staticmethod
+    def s(x):
+        return x + 1
+
+    @classmethod
+    def c(cls):
+        return cls.__name__
+
+class D(C):
+    pass
+
+for i in range(2):
+    print(D().s(i), D().c(), C().c())
+
+# a new class with the same name and layout must not see the old methods
+for i in range(3):
+    class E:
+        def f(self, i=i):
+            return i
+    print(E().f())
+
+# methods of built-in types
+l = []
+for i in range(3):
+    l.append(i)
+print(l, "abc".upper(), "abc".upper())
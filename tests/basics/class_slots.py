@@ -0,0 +1,80 @@
+# test classes that declare __slots__
+
+class Test:
+    __slots__ = ()
+
+try:
+    Test().a = 1
+except AttributeError:
+    pass
+else:
+    print("SKIP")
+    raise SystemExit
+
+class Point:
+    __slots__ = ("x", "y")
+
+    def __init__(self, x, y):
+        self.x = x
+        self.y = y
+
+    def norm2(self):
+        return self.x * self.x + self.y * self.y
+
+p = Point(3, 4)
+print(p.x, p.y, p.norm2())
+p.x += 1
+print(p.x, getattr(p, "y"), hasattr(p, "z"))
+
+# attributes not named in __slots__ can't be added
+try:
+    p.z = 1
+except AttributeError:
+    print("AttributeError")
+
+# a slot that has not been assigned, or has been deleted
+class Lazy:
+    __slots__ = ("a",)
+
+try:
+    Lazy().a
+except AttributeError:
+    print("AttributeError")
+del p.y
+print(hasattr(p, "y"))
+try:
+    del p.y
+except AttributeError:
+    print("AttributeError")
+p.y = 5
+print(p.y)
+
+# a single string names one slot
+class One:
+    __slots__ = "a"
+
+o = One()
+o.a = [1]
+print(o.a)
+
+# any iterable of names will do
+class Many:
+    __slots__ = ["a"] + ["b%d" % i for i in range(20)]
+
+m = Many()
+for i in range(20):
+    setattr(m, "b%d" % i, i)
+print(sum(getattr(m, "b%d" % i) for i in range(20)))
+
+# class attributes and methods are found through instances as usual
+class WithClassAttr:
+    __slots__ = ("a",)
+    b = 2
+
+    @property
+    def c(self):
+        return self.a * 10
+
+w = WithClassAttr()
+w.a = 1
+print(w.a, w.b, w.c)
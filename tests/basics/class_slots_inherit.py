@@ -0,0 +1,90 @@
+# test inheriting from and by classes that declare __slots__
+
+class Test:
+    __slots__ = ()
+
+try:
+    Test().a = 1
+except AttributeError:
+    pass
+else:
+    print("SKIP")
+    raise SystemExit
+
+class Point:
+    __slots__ = ("x", "y")
+
+    def __init__(self, x, y):
+        self.x = x
+        self.y = y
+
+    def norm2(self):
+        return self.x * self.x + self.y * self.y
+
+# slots are inherited, and a subclass can add more
+class Point3(Point):
+    __slots__ = ("z",)
+
+    def __init__(self, x, y, z):
+        super().__init__(x, y)
+        self.z = z
+
+p3 = Point3(1, 2, 3)
+print(p3.x, p3.y, p3.z, p3.norm2(), isinstance(p3, Point))
+try:
+    p3.w = 4
+except AttributeError:
+    print("AttributeError")
+
+# a subclass without __slots__ can have any attribute
+class Free(Point):
+    pass
+
+f = Free(5, 6)
+f.w = 7
+print(f.x, f.y, f.w, f.norm2())
+
+# as can a class with __slots__ whose base has no __slots__
+class Base:
+    pass
+
+class Slotted(Base):
+    __slots__ = ("a",)
+
+s = Slotted()
+s.a = 1
+s.b = 2
+print(s.a, s.b)
+
+# only one base may bring slots with it
+class A:
+    __slots__ = ("a",)
+
+class B:
+    __slots__ = ("b",)
+
+try:
+    class AB(A, B):
+        pass
+except TypeError:
+    print("TypeError")
+
+# reading and writing slots from the same code with different classes
+def get_x(o):
+    return o.x
+
+def set_x(o, v):
+    o.x = v
+
+class X:
+    __slots__ = ("q", "x")
+
+class Y:
+    def __init__(self):
+        self.x = "y"
+
+objs = [Point(1, 2), X(), Y(), Point3(3, 4, 5), Free(6, 7)]
+for o in objs:
+    set_x(o, type(o).__name__)
+for o in objs:
+    print(get_x(o))
@@ -0,0 +1,82 @@
+# test for loops over the builtin sequences
+
+try:
+    memoryview
+except NameError:
+    print("SKIP")
+    raise SystemExit
+
+for seq in (range(4), range(10, 0, -3), range(-2, 3, 2), range(0), range(5, 1),
+            [1, "a", None], [], (2, 3), (), b"xyz", b"", bytearray(b"\x00\x7f\xff")):
+    out = []
+    for x in seq:
+        out.append(x)
+    print(out)
+
+# a list that grows and shrinks while being iterated over
+l = [1, 2, 3]
+for x in l:
+    if x < 5:
+        l.append(x + 3)
+print(l)
+l = [1, 2, 3, 4, 5, 6]
+out = []
+for x in l:
+    out.append(x)
+    l.pop()
+print(out, l)
+
+# a bytearray that grows while being iterated over
+b = bytearray(b"ab")
+for x in b:
+    if x < 100:
+        b.append(x + 10)
+print(b)
+
+# memoryviews, including ones that start part way into their buffer
+m = memoryview(b"0123456789")
+print([x for x in m], [x for x in m[3:6]])
+for x in m[7:]:
+    print(x)
+
+# nested loops, break, continue and else
+out = []
+for i in range(3):
+    for c in b"ab":
+        if i == 1:
+            continue
+        for t in (i, c):
+            if t == 98:
+                break
+            out.append(t)
+        else:
+            out.append(None)
+print(out)
+
+# loops inside a generator, which keep their position between yields
+def gen(seqs):
+    for seq in seqs:
+        for x in seq:
+            yield x
+
+print(list(gen([range(2), [3, 4], (5,), b"\x06", bytearray(b"\x07")])))
+g = gen([[1, 2], [3]])
+print(next(g), next(g))
+g.close()
+
+# an exception from inside the loop
+try:
+    for x in [1, 2, 0]:
+        1 // x
+except ZeroDivisionError:
+    print("ZeroDivisionError", x)
+
+# tuple subclasses and other iterables still work
+class T(tuple):
+    pass
+
+class L(list):
+    def __iter__(self):
+        return iter([9])
+
+print([x for x in T((1, 2))], [x for x in L([1, 2])], [x for x in {1: 2}], [x for x in "ab"])
@@ -0,0 +1,86 @@
+# test for loops that unpack each value into several variables
+
+d = {"a": 1, "b": 2, "c": 3}
+print(sorted((k, v) for k, v in d.items()))
+out = []
+for k, v in d.items():
+    out.append((v, k))
+print(sorted(out))
+
+for i, x in enumerate("abc"):
+    print(i, x)
+for i, x in enumerate([4, 5], 10):
+    print(i, x)
+
+for a, b in zip(range(3), "xyz"):
+    print(a, b)
+for a, b, c in zip([1, 2], (3, 4, 5), b"67"):
+    print(a, b, c)
+
+# nested unpacking, and values that are not tuples
+for (i, x), y in zip(enumerate("ab"), "cd"):
+    print(i, x, y)
+for a, b in [(1, 2), [3, 4], "56", range(7, 9)]:
+    print(a, b)
+print([a + b for a, b in zip((1, 2), (3, 4))])
+print(sorted({k: i for i, k in enumerate("xy")}.items()))
+
+def gen():
+    yield 1, 2
+    yield 3, 4
+
+for a, b in gen():
+    print(a, b)
+
+# the wrong number of values
+for it in (enumerate([1]), zip([1], [2], [3]), {1: 2}.items(), [(1, 2, 3)], [(1,)], [5]):
+    try:
+        for a, b in it:
+            print(a, b)
+    except (ValueError, TypeError) as e:
+        print(type(e).__name__)
+
+# keys and values are not unpacked
+for a, b in {(1, 2): 0}.keys():
+    print(a, b)
+for a, b in {0: (3, 4)}.values():
+    print(a, b)
+
+# break, else and exceptions inside the loop
+for i, x in enumerate("abc"):
+    if x == "b":
+        break
+else:
+    print("no break")
+print(i, x)
+for a, b in zip([], []):
+    pass
+else:
+    print("else")
+try:
+    for k, v in {"x": 0}.items():
+        1 // v
+except ZeroDivisionError:
+    print("ZeroDivisionError", k)
+
+# an iterator that raises StopIteration itself
+class It:
+    def __init__(self):
+        self.n = 0
+    def __iter__(self):
+        return self
+    def __next__(self):
+        self.n += 1
+        if self.n > 2:
+            raise StopIteration
+        return self.n, -self.n
+
+for a, b in It():
+    print(a, b)
+
+# inside a generator, which keeps its position between yields
+def pairs(d):
+    for i, (k, v) in enumerate(sorted(d.items())):
+        yield i, k, v
+
+print(list(pairs(d)))
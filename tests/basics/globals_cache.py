@@ -0,0 +1,74 @@
+# test that cached global and builtin name lookups see later changes
+
+def f():
+    return len("abc")
+
+print(f(), f())
+
+# shadow the builtin with a global, then remove it again
+len = lambda x: -1
+print(f())
+del len
+print(f())
+
+# shadow and remove it through the globals dict
+globals()["len"] = lambda x: -2
+print(f())
+globals().pop("len")
+print(f())
+
+# a global whose value changes without changing the keys
+x = 1
+def g():
+    return x
+print(g())
+for i in range(3):
+    x = i
+    print(g())
+
+# many new globals, forcing the globals dict to grow
+def h():
+    return y
+y = 0
+for i in range(40):
+    globals()["z%d" % i] = i
+    y = i
+print(h())
+del y
+try:
+    h()
+except NameError:
+    print("NameError")
+
+# the same code run with different globals
+code = compile("r = len(s)", "<test>", "exec")
+for s in ("a", "bb"):
+    d = {"s": s}
+    exec(code, d)
+    print(d["r"])
+d = {"s": "ccc", "len": lambda x: "own len"}
+exec(code, d)
+print(d["r"])
+
+# module level loads and class bodies
+class C:
+    len = 5
+    n = len
+print(C.n, len("xy"))
+
+# code freed and replaced by other code at the same address
+try:
+    import gc
+except ImportError:
+    gc = None
+d = {"s": "abc", "r": 0}
+stale = 0
+for n in range(0, 400, 10):
+    exec(compile("\n" * n + "r = len(s)", "<test>", "exec"), d)
+    if gc:
+        gc.collect()
+    exec(compile("\n" * n + "r = type(s)", "<test>", "exec"), d)
+    stale += d["r"] is not str
+    if gc:
+        gc.collect()
+print(stale)
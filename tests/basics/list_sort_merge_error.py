@@ -0,0 +1,23 @@
+# test that a comparison failing in the middle of a merge leaves all items in
+# the list, whichever run the merge copied out
+
+class Bad:
+    def __eq__(self, other):
+        raise ValueError
+a, b = Bad(), Bad()
+for left_longer in (True, False):
+    l = [(v, a) for v in range(0, 200, 2)]
+    odd = [(v, b) for v in sorted(list(range(1, 100, 2)) + [50])]
+    if left_longer:
+        l.extend(odd)
+    else:
+        l[0:0] = odd
+    odd = None
+    try:
+        l.sort()
+    except ValueError:
+        print("ValueError")
+    total = 0
+    for t in l:
+        total += t[0]
+    print(len(l), total)
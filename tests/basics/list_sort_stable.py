@@ -0,0 +1,40 @@
+# test the stability of sorting, how often the key function is called, and
+# lists with runs of sorted items
+
+# equal items keep their order, including in reverse
+l = list(range(90))
+print(sorted(l, key=lambda x: x % 3) == [x for k in range(3) for x in l if x % 3 == k])
+print(sorted(l, key=lambda x: x % 3, reverse=True) == [x for k in range(2, -1, -1) for x in l if x % 3 == k])
+
+class A:
+    def __init__(self, x):
+        self.x = x
+    def __lt__(self, other):
+        return self.x < other.x
+
+l = [A(i % 5) for i in range(20)]
+print([id(x) for x in sorted(l)] == [id(x) for k in range(5) for x in l if x.x == k])
+
+# the key function is called once for each item
+n = 0
+def key(x):
+    global n
+    n += 1
+    return x % 10
+l = list(range(100, 0, -1))
+l.sort(key=key)
+print(n, l[:12])
+
+# lists with runs, and of each kind of item
+for l in ([5, 6, 7, 1, 2, 3, 9, 8, 4] * 8, list(range(40)) + list(range(40, 0, -1)),
+          [-1, 1 << 70, 3, -(1 << 70), True], ["b", "ab", "", "a", "ba", "é", "z"] * 10):
+    s = sorted(l)
+    print(s == sorted(l, reverse=True)[::-1], all(not (s[i + 1] < s[i]) for i in range(len(s) - 1)))
+
+# a failed comparison leaves all items in the list
+l = list(range(70, 0, -1)) + ["x"] + list(range(70))
+try:
+    l.sort()
+except TypeError:
+    print("TypeError")
+print(len(l), sum(x for x in l if x != "x"))
@@ -0,0 +1,22 @@
+# test repeated lookups in fixed tables: builtin modules, native types and
+# keyword arguments to native functions, which share a table position per call
+
+import sys
+
+for i in range(3):
+    print(sys.byteorder in ("little", "big"), type(sys.maxsize))
+    print([].append is not None, hasattr([], "no_such_attr"), hasattr([], "append"))
+    print(abs(-i), len("ab"), isinstance(i, int))
+
+# the same keyword names in different orders land in different slots
+for i in range(3):
+    print(i, i + 1, sep=":", end="!\n")
+    print(i, i + 1, end="?\n", sep="-")
+    print(sorted([3, 1, 2], reverse=True, key=lambda x: x))
+    print(sorted([3, 1, 2], key=lambda x: -x, reverse=i == 1))
+
+# a keyword that isn't accepted is still rejected after valid ones are cached
+try:
+    print(1, sep=" ", bad=1)
+except TypeError:
+    print("TypeError")
@@ -0,0 +1,72 @@
+# test sequences of loads and operations that are compiled to a single opcode
+
+def arith(a, b):
+    return a + b, a - b, a * b, a // b, a % b, a << 3, a - 1, a + -1000000, a & 0xff
+
+print(arith(100, 7))
+print(arith(2 ** 40, 3))
+
+def compare(a, b, c):
+    return a < c, a == c, a is None, a is not None, a in b, a not in b
+
+print(compare(1, [1, 2], 2))
+print(compare("x", "xyz", "w"))
+
+# in-place operations on locals
+def accumulate(n):
+    acc = 0
+    i = 0
+    while i < n:
+        acc += i
+        acc = acc ^ i
+        i += 1
+    return acc
+
+print(accumulate(100))
+
+# attributes and methods of locals
+class A:
+    def __init__(self):
+        self.x = 1
+
+    def get(self, k):
+        return self.x + k
+
+def attrs(a, l):
+    l.append(a.x)
+    return a.x, a.get(2), l, "abc".upper()
+
+print(attrs(A(), []))
+
+# operands that are unbound locals
+def unbound_lhs():
+    b = 1
+    if 0:
+        a = 0
+    return a + b
+
+def unbound_rhs():
+    a = 1
+    if 0:
+        b = 0
+    return a + b
+
+def unbound_attr():
+    if 0:
+        a = 0
+    return a.x
+
+for f in (unbound_lhs, unbound_rhs, unbound_attr):
+    try:
+        f()
+    except NameError:
+        print("NameError")
+
+# operations that raise
+def fail(a, b):
+    return a + b
+
+try:
+    fail(1, "a")
+except TypeError:
+    print("TypeError")
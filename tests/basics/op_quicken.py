@@ -0,0 +1,94 @@
+# test that operations give the same results when their operand types change
+# from one execution to the next, as the VM may specialise them for the types
+# it has seen
+
+def arith(a, b):
+    return (a + b, a - b, a < b, a > b, a <= b, a >= b)
+
+def inplace(a, b):
+    a += b
+    c = a
+    c -= b
+    return a, c
+
+def mul(a, b):
+    return a * b
+
+def local_ops(a):
+    return (a + 1, a - 2, a < 3, a * 6, a == 4, a != 4)
+
+args = [
+    (1, 2), (3, -4), (5, 6),
+    (1.5, 2), (2, 0.25), (0.5, 0.5),
+    ("ab", "cd"), ([1], [2]), ((1,), (2,)),
+    (1 << 29, 1 << 29), (1 << 62, 1 << 62), (-(1 << 62), -(1 << 62)),
+    (7, 8),
+]
+for a, b in args:
+    try:
+        print(arith(a, b))
+    except TypeError:
+        print("TypeError", a + b)
+    try:
+        print(inplace(a, b))
+    except TypeError:
+        print("TypeError")
+    try:
+        print(mul(a, b))
+    except TypeError:
+        print("TypeError")
+
+# a mutable object changed in place by +=
+def iadd(a, b):
+    a += b
+    return a
+
+print(iadd(1, 2), iadd(0.5, 2))
+l = [1]
+print(iadd(l, [2]), l)
+
+for a in (1, 4, 1 << 62, 5.0, True, 9):
+    print(local_ops(a))
+
+# subscripts
+def get(seq, i):
+    return seq[i]
+
+for seq, i in (([1, 2, 3], 0), ([1, 2, 3], -1), ((4, 5), 1), ((4, 5), -2), ([1, 2, 3], 2),
+               ("abc", 1), ({0: "x"}, 0), ([1, 2, 3], True), ([1, 2, 3], 1)):
+    print(get(seq, i))
+
+for seq, i in (([1, 2, 3], 3), ((4, 5), -3), ([], 0)):
+    try:
+        get(seq, i)
+    except IndexError:
+        print("IndexError")
+
+class List(list):
+    def __getitem__(self, i):
+        return "List", i
+
+print(get([1], 0), get(List([1]), 0), get([1], 0))
+
+# for loops over different iterables at the same site
+def loop(it):
+    out = []
+    for x in it:
+        out.append(x)
+    return out
+
+for it in (range(3), range(10, 0, -3), range(0), [4, 5], range(2), "ab", (6,), range(1, 2)):
+    print(loop(it))
+
+# a range loop interrupted and restarted
+def nested():
+    out = []
+    for i in range(3):
+        for j in range(i):
+            if j == 1:
+                break
+            out.append((i, j))
+    return out
+
+print(nested())
+print(nested())
@@ -0,0 +1,14 @@
+# Function call overhead test
+# Perform the same trivial operation as calling function, from a function
+# with enough locals that its frame is too big to go on the C stack
+import bench
+
+def f(x):
+    a = b = c = d = e = g = h = x
+    return a + 1
+
+def test(num):
+    for i in iter(range(num)):
+        a = f(i)
+
+bench.run(test)
@@ -0,0 +1,7 @@
+import bench
+
+def test(num):
+    for i in iter(range(num // 1000)):
+        bytearray(8192)
+
+bench.run(test)
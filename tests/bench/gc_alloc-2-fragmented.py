@@ -0,0 +1,15 @@
+import bench
+
+def test(num):
+    # Fill the heap with small objects and drop every other one, so the free
+    # space that remains after a collection is split into short runs.
+    l = [bytes(100) for i in range(num // 10000)]
+    for i in range(0, len(l), 2):
+        l[i] = None
+    l2 = [bytes(100) for i in range(num // 10000)]
+    for i in range(0, len(l2), 2):
+        l2[i] = None
+    for i in iter(range(num // 1000)):
+        bytearray(8192)
+
+bench.run(test)
@@ -0,0 +1,8 @@
+import bench
+
+def test(num):
+    l = [(i * 7919) % 1000 for i in range(1000)]
+    for i in iter(range(num // 20000)):
+        sorted(l)
+
+bench.run(test)
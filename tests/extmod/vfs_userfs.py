@@ -19,8 +19,9 @@ class UserFile(uio.IOBase):
     def read(self):
         return self.data
     def readinto(self, buf):
+        # return at most 8 bytes at a time, as a stream is allowed to
         n = 0
-        while n < len(buf) and self.pos < len(self.data):
+        while n < len(buf) and n < 8 and self.pos < len(self.data):
             buf[n] = self.data[self.pos]
             n += 1
             self.pos += 1
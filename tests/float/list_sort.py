@@ -0,0 +1,8 @@
+# test sorting lists of floats, and of floats mixed with ints
+
+l = [0.5, -1.25, 3.0, 1e10, -0.0, 2.5, 0.25] * 10
+s = sorted(l)
+print(s[:7], s[-1])
+print(sorted(l, reverse=True)[:7])
+print(sorted([2, 0.5, -1, 1.5, 0, True]))
+print(sorted([(1.5, "a"), (0.5, "b")], key=lambda x: x[0]))
@@ -0,0 +1,24 @@
+# test importing a module of many top-level statements
+
+# With a module cache the module is only streamed when its cache file can't be
+# written, so put a directory in the way of it.
+try:
+    import uos
+    uos.mkdir, uos.rmdir
+except (ImportError, AttributeError):
+    uos = None
+if uos:
+    try:
+        uos.mkdir("import/import_stream1.mpc")
+    except OSError:
+        pass
+
+import import_stream1 as m
+
+print(m.SCALE, m.TABLE, m.status, m.counter)
+print(m.total(), m.value())
+print(m.Point.dims, m.p.x, m.p.y)
+print(sorted([k for k in dir(m) if not k.startswith("_")]))
+
+if uos:
+    uos.rmdir("import/import_stream1.mpc")
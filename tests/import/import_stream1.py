@@ -0,0 +1,49 @@
+# a module of many top-level statements, each of which refers to names bound
+# by the others, whichever order they come in
+
+try:
+    const
+except NameError:
+    const = lambda x: x
+
+_SIZE = const(4)
+SCALE = const(_SIZE * 3)
+
+def total():
+    # refers to a global that is only bound further down
+    return sum(TABLE) + SCALE
+
+"""a lone string between statements"""
+
+class Point:
+    dims = _SIZE - 2
+    def __init__(self, x, y):
+        self.x = x
+        self.y = y
+    def scaled(self):
+        return Point(self.x * SCALE, self.y * SCALE)
+
+TABLE = [i * i for i in range(_SIZE)]
+
+if len(TABLE) == _SIZE:
+    status = "ok"
+else:
+    status = "bad"
+
+try:
+    missing
+except NameError:
+    status += "!"
+
+counter = 0
+for n in TABLE:
+    counter += n
+
+def deco(f):
+    return lambda: f() + counter
+
+@deco
+def value():
+    return total()
+
+p = Point(1, 2).scaled()
@@ -0,0 +1,72 @@
+# test that an imported .py file is compiled once and then loaded from a
+# cache file holding its compiled code, for as long as the source is unchanged
+
+import sys
+try:
+    import uos
+    uos.stat, uos.remove
+except (ImportError, AttributeError):
+    print("SKIP")
+    raise SystemExit
+
+MOD = "module_cache_tmp"
+
+def write(name, data):
+    with open(name, "wb") as f:
+        f.write(data)
+
+def read(name):
+    try:
+        with open(name, "rb") as f:
+            return f.read()
+    except OSError:
+        return None
+
+def load():
+    sys.modules.pop(MOD, None)
+    return __import__(MOD)
+
+def cleanup():
+    for ext in (".py", ".mpc"):
+        try:
+            uos.remove(MOD + ext)
+        except OSError:
+            pass
+    sys.path.pop(0)
+
+sys.path.insert(0, "")
+write(MOD + ".py", b"x = 1\n")
+load()
+if read(MOD + ".mpc") is None:
+    cleanup()
+    print("SKIP")
+    raise SystemExit
+
+# the cache file has a header followed by the .mpy data
+write(MOD + ".py", b"def f(a, *b):\n    return [x * a for x in b]\nprint('run', f(2, 3, 4))\n")
+m = load()
+cache = read(MOD + ".mpc")
+print(cache[0:1], cache[9:10])
+
+# the second import runs the same code, loaded from the cache
+m = load()
+print(m.f(3, 1), m.__file__.endswith(MOD + ".py"))
+print(read(MOD + ".mpc") == cache)
+
+# changing the source compiles it again
+write(MOD + ".py", b"print('changed')\n")
+load()
+cache = read(MOD + ".mpc")
+print(cache[9:10])
+
+# a cache file from an incompatible version is replaced
+write(MOD + ".mpc", cache[:10] + b"\x00" + cache[11:])
+load()
+print(read(MOD + ".mpc") == cache)
+
+# so is one that isn't stamped
+write(MOD + ".mpc", b"C" + bytes(8) + cache[9:])
+load()
+print(read(MOD + ".mpc") == cache)
+
+cleanup()
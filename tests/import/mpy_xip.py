@@ -0,0 +1,72 @@
+# test running a .mpy file whose bytecode stays where the file is mapped, with
+# the .mpy made from the compiled code that the module cache saves
+
+import sys
+try:
+    import uos
+    uos.stat, uos.remove
+except (ImportError, AttributeError):
+    print("SKIP")
+    raise SystemExit
+
+SRC = "mpy_xip_src"
+MOD = "mpy_xip_tmp"
+
+def write(name, data):
+    with open(name, "wb") as f:
+        f.write(data)
+
+def read(name):
+    try:
+        with open(name, "rb") as f:
+            return f.read()
+    except OSError:
+        return None
+
+def cleanup():
+    for name in (SRC + ".py", SRC + ".mpc", MOD + ".mpy"):
+        try:
+            uos.remove(name)
+        except OSError:
+            pass
+    sys.path.pop(0)
+
+sys.path.insert(0, "")
+write(SRC + ".py", b"""
+X = 42
+def f(a, b=3, *, c=4):
+    return [a, b, c, X, len("hello")]
+class C:
+    def m(self, k):
+        return self.__class__.__name__ + str(k)
+    @property
+    def p(self):
+        return "prop"
+def gen(n):
+    for i in range(n):
+        yield i * X
+def boom():
+    raise ValueError("boom")
+""")
+__import__(SRC)
+mpc = read(SRC + ".mpc")
+if mpc is None:
+    cleanup()
+    print("SKIP")
+    raise SystemExit
+
+# skip the magic byte and stamp of the cache file
+write(MOD + ".mpy", mpc[9:])
+uos.remove(SRC + ".mpc")
+mod = __import__(MOD)
+
+print(mod.X, mod.f(1), mod.f(1, 2, c=5))
+print(mod.C().m(5), mod.C().p)
+print(list(mod.gen(4)))
+print(mod.f.__name__, mod.C.m.__name__)
+try:
+    mod.boom()
+except ValueError as e:
+    print(repr(e))
+
+cleanup()
@@ -0,0 +1,42 @@
+# test that gc.compact keeps the contents of the buffers it moves
+
+import gc
+
+try:
+    gc.compact
+except AttributeError:
+    print("SKIP")
+    raise SystemExit
+
+try:
+    import array
+except ImportError:
+    array = None
+
+# grow buffers with garbage allocated in between, so their storage is spread out
+bufs = [bytearray() for i in range(8)]
+lists = [[] for i in range(8)]
+junk = []
+for r in range(8):
+    for i in range(8):
+        bufs[i].extend(b"%d" % i * 10)
+        lists[i].append((r, i))
+        junk.append(bytearray(64))
+junk = None
+if array:
+    arr = array.array("i", range(50))
+
+# a memoryview pins the buffer it refers to
+mv = memoryview(bufs[0])
+
+gc.compact()
+
+print(all(bufs[i] == b"%d" % i * 80 for i in range(8)))
+print(all(lists[i] == [(r, i) for r in range(8)] for i in range(8)))
+print(array is None or list(arr) == list(range(50)))
+print(bytes(mv[:3]), mv[79] == ord("0"))
+
+# the moved buffers still work
+bufs[1].extend(b"x")
+lists[1].append(None)
+print(bufs[1][-2:], lists[1][-2:])
@@ -0,0 +1,43 @@
+# test that function frames on the pystack are released however calls end
+import micropython
+
+try:
+    micropython.pystack_use
+except AttributeError:
+    print('SKIP')
+    raise SystemExit
+
+def f(n):
+    a = b = c = d = e = g = h = n
+    if n == 0:
+        raise ValueError
+    return f(n - 1) + a
+
+def gen(n):
+    for i in range(n):
+        a = b = c = d = e = g = h = i
+        yield a + h
+
+def rec(n):
+    return rec(n + 1)
+
+base = micropython.pystack_use()
+
+# exception raised from deep in a call chain
+try:
+    f(10)
+except ValueError:
+    print('ValueError')
+print(micropython.pystack_use() == base)
+
+# generators keep their frame between calls to next()
+g = gen(3)
+print(next(g), micropython.pystack_use() == base)
+print(list(g), micropython.pystack_use() == base)
+
+# running out of room is reported, and the room is given back afterwards
+try:
+    rec(0)
+except RuntimeError:
+    print('RuntimeError')
+print(micropython.pystack_use() == base)
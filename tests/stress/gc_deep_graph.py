@@ -0,0 +1,51 @@
+# test that the GC can trace object graphs much deeper and wider than its mark stack
+
+try:
+    import gc
+except ImportError:
+    print("SKIP")
+    raise SystemExit
+
+# a long list of dicts
+dicts = [{"i": i, "s": str(i)} for i in range(500)]
+
+# the same, but with the items allocated in the opposite order to the list
+rev = [{"i": i} for i in range(500)]
+rev.reverse()
+
+# a deep chain of nested lists
+chain = None
+for i in range(1000):
+    chain = [i, chain]
+
+# a tree of groups, like a display tree
+class Group:
+    def __init__(self, depth):
+        self.children = []
+        if depth > 0:
+            for i in range(3):
+                self.children.append(Group(depth - 1))
+
+    def count(self):
+        n = 1
+        for c in self.children:
+            n += c.count()
+        return n
+
+tree = Group(5)
+
+for _ in range(3):
+    gc.collect()
+    # reuse any memory that was freed by mistake
+    junk = [bytearray(16) for i in range(500)]
+    del junk
+
+print(sum(d["i"] for d in dicts), all(d["s"] == str(d["i"]) for d in dicts))
+print(sum(d["i"] for d in rev), rev[0]["i"], rev[-1]["i"])
+n = 0
+c = chain
+while c is not None:
+    n += c[0]
+    c = c[1]
+print(n)
+print(tree.count())
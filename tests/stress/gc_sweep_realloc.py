@@ -0,0 +1,17 @@
+# test growing objects in place while the sweep after a collection is pending
+
+seed = 12345
+def rnd(n):
+    global seed
+    seed = (seed * 1103515245 + 12345) & 0x7fffffff
+    return seed % n
+
+ok = True
+for it in range(20):
+    n = 3000
+    l = [(rnd(6), i) for i in range(n)]
+    a = sorted(l, key=lambda x: x[0])
+    b = sorted(l, key=lambda x: x[0], reverse=True)
+    l = [rnd(3) for _ in range(n // 3)] + list(range(n // 3)) + [1 << 40] * 3 + list(range(n, 0, -2))
+    ok = ok and all(isinstance(x, int) for x in l) and len(a) == len(b) == n
+print(ok)
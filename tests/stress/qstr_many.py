@@ -0,0 +1,20 @@
+# test interning and looking up many more qstrs than fit in one pool
+
+class A:
+    pass
+
+a = A()
+n = 500
+
+# looking up an attribute by name interns the name
+print(any(hasattr(a, "attr_%d" % i) for i in range(n)))
+
+# some of the names get values, looked up again from freshly built strings
+for i in range(0, n, 50):
+    setattr(a, "attr_%d" % i, i)
+print(all(getattr(a, "attr_%d" % i, -1) == (i if i % 50 == 0 else -1) for i in range(n)))
+print(hasattr(a, "attr_%d" % n), hasattr(a, "attr_"))
+
+# names that are already interned in ROM
+print(hasattr(a, "append"), getattr([], "append" + "")(1))
+print(getattr(a, "__class__".replace("x", "")) is A)
@@ -0,0 +1,30 @@
+# test that a collection traces each object once, even when the object graph
+# is much wider than the GC mark stack and overflows it behind the scan
+
+try:
+    gc_mark_count
+except NameError:
+    print("SKIP")
+    raise SystemExit
+
+import gc
+import sys
+
+# a GC block is four machine words
+block_size = 32 if sys.maxsize > 2**32 else 16
+
+# lists whose items are allocated before the list itself
+groups = []
+for i in range(80):
+    groups.append([[j] for j in range(80)])
+
+# the same with the items in the opposite order to the list
+rev = [{"i": i} for i in range(500)]
+rev.reverse()
+
+gc.collect()
+n = gc_mark_count()
+# every chain traced starts at a block in use, so tracing each chain once stays
+# within the number of blocks in use; tracing them again on every pass doesn't
+print(0 < n <= gc.mem_alloc() // block_size)
+print(sum(len(g) for g in groups), sum(d["i"] for d in rev))
@@ -57,7 +57,7 @@ class FreezeError(Exception):
         return 'error while freezing %s: %s' % (self.rawcode.source_file, self.msg)
 
 class Config:
-    MPY_VERSION = 3
+    MPY_VERSION = 5
     MICROPY_LONGINT_IMPL_NONE = 0
     MICROPY_LONGINT_IMPL_LONGLONG = 1
     MICROPY_LONGINT_IMPL_MPZ = 2
@@ -77,6 +77,12 @@ MP_BC_LOAD_NAME = 0x1c
 MP_BC_LOAD_GLOBAL = 0x1d
 MP_BC_LOAD_ATTR = 0x1e
 MP_BC_STORE_ATTR = 0x26
+# superinstructions, with extra bytes after their first argument:
+MP_BC_LOAD_FAST_ATTR = 0x48
+MP_BC_LOAD_FAST_METHOD = 0x49
+MP_BC_BINARY_OP_FAST_FAST = 0x4a
+MP_BC_BINARY_OP_FAST_SMALL_INT = 0x4b
+MP_BC_FOR_ITER_UNPACK = 0x4d
 
 # load opcode names
 opcode_names = {}
@@ -118,8 +124,8 @@ def make_opcode_format():
     OC4(U, O, B, O), # 0x3c-0x3f
     OC4(O, B, B, O), # 0x40-0x43
     OC4(B, B, O, B), # 0x44-0x47
-    OC4(U, U, U, U), # 0x48-0x4b
-    OC4(U, U, U, U), # 0x4c-0x4f
+    OC4(Q, Q, B, V), # 0x48-0x4b
+    OC4(U, O, U, U), # 0x4c-0x4f
     OC4(V, V, U, V), # 0x50-0x53
     OC4(B, U, V, V), # 0x54-0x57
     OC4(V, V, V, B), # 0x58-0x5b
@@ -179,6 +185,8 @@ def mp_opcode_format(bytecode, ip, opcode_format=make_opcode_format()):
     f = (opcode_format[opcode >> 2] >> (2 * (opcode & 3))) & 3
     if f == MP_OPCODE_QSTR:
         ip += 3
+        if opcode == MP_BC_LOAD_FAST_ATTR or opcode == MP_BC_LOAD_FAST_METHOD:
+            ip += 1
     else:
         extra_byte = (
             opcode == MP_BC_RAISE_VARARGS
@@ -191,6 +199,12 @@ def mp_opcode_format(bytecode, ip, opcode_format=make_opcode_format()):
                 or opcode == MP_BC_STORE_ATTR
             )
         )
+        if opcode == MP_BC_BINARY_OP_FAST_SMALL_INT:
+            extra_byte = 2
+        elif opcode == MP_BC_BINARY_OP_FAST_FAST:
+            extra_byte = 3
+        elif opcode == MP_BC_FOR_ITER_UNPACK:
+            extra_byte = 1
         ip += 1
         if f == MP_OPCODE_VAR_UINT:
             while bytecode[ip] & 0x80 != 0:
@@ -305,7 +319,7 @@ class RawCode:
                 opcode = '0x%02x' % opcode
             if f == 1:
                 qst = self._unpack_qstr(ip + 1).qstr_id
-                print('    {}, {} & 0xff, {} >> 8,'.format(opcode, qst, qst))
+                print('    {}, {} & 0xff, {} >> 8,{}'.format(opcode, qst, qst, ''.join(' 0x%02x,' % self.bytecode[ip + i] for i in range(3, sz))))
             else:
                 print('    {},{}'.format(opcode, ''.join(' 0x%02x,' % self.bytecode[ip + i] for i in range(1, sz))))
             ip += sz